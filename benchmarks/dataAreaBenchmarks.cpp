@@ -0,0 +1,457 @@
+//
+// Micro-benchmarks for Modbus::DataArea and the PDU handlers that sit on top of it.
+//
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <ModbusDataArea.h>
+#include <ModbusPDU.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Runs fn the given number of times and returns the mean time per iteration in nanoseconds.
+     */
+    template<typename Function>
+    double measureNanoseconds(int iterations, Function &&fn) {
+        auto begin = Clock::now();
+        for (int i = 0; i < iterations; ++i)
+            fn();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin);
+        return static_cast<double>(elapsed.count()) / iterations;
+    }
+
+    void printResult(const std::string &name, double nanoseconds) {
+        std::cout << std::left << std::setw(60) << name << std::right << std::setw(12) << std::fixed
+                  << std::setprecision(1) << nanoseconds << " ns/op" << std::endl;
+    }
+
+    /**
+     * @brief Builds a Write Multiple Registers request PDU for quantity registers starting at startAddress.
+     */
+    std::vector<std::byte> writeMultipleRegistersRequest(uint16_t startAddress, uint16_t quantity) {
+        auto [startMSB, startLSB] = Modbus::Utilities::uint16ToTwoBytes(startAddress);
+        auto [quantityMSB, quantityLSB] = Modbus::Utilities::uint16ToTwoBytes(quantity);
+        std::vector<std::byte> request{static_cast<std::byte>(Modbus::FunctionCode::WriteMultipleRegisters),
+                                       startMSB, startLSB, quantityMSB, quantityLSB,
+                                       static_cast<std::byte>(quantity * 2)};
+        for (int i = 0; i < quantity; ++i) {
+            auto [valueMSB, valueLSB] = Modbus::Utilities::uint16ToTwoBytes(static_cast<uint16_t>(i));
+            request.push_back(valueMSB);
+            request.push_back(valueLSB);
+        }
+        return request;
+    }
+
+    /**
+     * @brief Builds a Write Multiple Coils request PDU for quantity coils starting at startAddress.
+     */
+    std::vector<std::byte> writeMultipleCoilsRequest(uint16_t startAddress, uint16_t quantity) {
+        auto [startMSB, startLSB] = Modbus::Utilities::uint16ToTwoBytes(startAddress);
+        auto [quantityMSB, quantityLSB] = Modbus::Utilities::uint16ToTwoBytes(quantity);
+        auto byteCount = Modbus::calculateBytesFromBits(quantity);
+        std::vector<std::byte> request{static_cast<std::byte>(Modbus::FunctionCode::WriteMultipleCoils),
+                                       startMSB, startLSB, quantityMSB, quantityLSB,
+                                       static_cast<std::byte>(byteCount)};
+        request.resize(request.size() + byteCount, std::byte{0xA5});
+        return request;
+    }
+
+    /**
+     * @brief Builds a read request PDU, e.g. Read Holding Registers, for quantity points starting at startAddress.
+     */
+    std::vector<std::byte> readRequest(Modbus::FunctionCode functionCode, uint16_t startAddress, uint16_t quantity) {
+        auto [startMSB, startLSB] = Modbus::Utilities::uint16ToTwoBytes(startAddress);
+        auto [quantityMSB, quantityLSB] = Modbus::Utilities::uint16ToTwoBytes(quantity);
+        return {static_cast<std::byte>(functionCode), startMSB, startLSB, quantityMSB, quantityLSB};
+    }
+
+    /**
+     * Write Multiple Registers latency for growing map sizes. The request always targets the last
+     * MAX_HOLDING_REGISTERS registers of the map, so a linear lookup would show up as growing latency.
+     */
+    void benchmarkWriteMultipleRegistersByMapSize() {
+        for (int mapSize: {Modbus::MAX_HOLDING_REGISTERS, 1024, 8192, Modbus::MAX_REGISTER_DATA_AREA_SIZE}) {
+            Modbus::DataArea dataArea;
+            dataArea.generateHoldingRegisters(0, mapSize);
+            auto request = writeMultipleRegistersRequest(mapSize - Modbus::MAX_HOLDING_REGISTERS,
+                                                         Modbus::MAX_HOLDING_REGISTERS);
+            std::array<std::byte, Modbus::MAX_PDU_LENGTH> response{};
+            auto nanoseconds = measureNanoseconds(20000, [&]() {
+                Modbus::PDU pdu(std::span<const std::byte>(request), dataArea);
+                pdu.buildResponse(response);
+            });
+            printResult("WriteMultipleRegisters x123, map size " + std::to_string(mapSize), nanoseconds);
+        }
+    }
+
+    /**
+     * Write Multiple Coils latency for the largest request a Modbus TCP frame can carry (1968 coils).
+     */
+    void benchmarkWriteMultipleCoils() {
+        constexpr int quantity = 1968;
+        Modbus::DataArea dataArea;
+        dataArea.generateCoils(0, quantity);
+        auto request = writeMultipleCoilsRequest(0, quantity);
+        std::array<std::byte, Modbus::MAX_PDU_LENGTH> response{};
+        auto nanoseconds = measureNanoseconds(20000, [&]() {
+            Modbus::PDU pdu(std::span<const std::byte>(request), dataArea);
+            pdu.buildResponse(response);
+        });
+        printResult("WriteMultipleCoils x1968", nanoseconds);
+    }
+
+    /**
+     * Write Multiple Registers latency with a growing number of change subscribers, each counting notifications.
+     */
+    void benchmarkWriteMultipleRegistersBySubscriberCount() {
+        for (int subscribers: {0, 1, 4}) {
+            Modbus::DataArea dataArea;
+            dataArea.generateHoldingRegisters(0, Modbus::MAX_HOLDING_REGISTERS);
+            long notifications = 0;
+            for (int i = 0; i < subscribers; ++i)
+                dataArea.subscribe([&notifications](const Modbus::DataChange &) { ++notifications; });
+            auto request = writeMultipleRegistersRequest(0, Modbus::MAX_HOLDING_REGISTERS);
+            std::array<std::byte, Modbus::MAX_PDU_LENGTH> response{};
+            auto nanoseconds = measureNanoseconds(20000, [&]() {
+                Modbus::PDU pdu(std::span<const std::byte>(request), dataArea);
+                pdu.buildResponse(response);
+            });
+            printResult("WriteMultipleRegisters x123, " + std::to_string(subscribers) + " subscriber(s)",
+                        nanoseconds);
+        }
+    }
+
+    /**
+     * Latency of requests that address registers missing from the map, as sent by scanners probing the address
+     * space, each answered with an IllegalDataAddress exception.
+     */
+    void benchmarkInvalidAddressRequests() {
+        Modbus::DataArea dataArea;
+        dataArea.generateCoils(0, 100);
+        dataArea.generateHoldingRegisters(0, 100);
+        std::array<std::byte, Modbus::MAX_PDU_LENGTH> response{};
+        for (auto [name, request]: {
+                std::pair{"ReadCoils x16, missing addresses",
+                          readRequest(Modbus::FunctionCode::ReadCoils, 1000, 16)},
+                std::pair{"ReadHoldingRegisters x16, missing addresses",
+                          readRequest(Modbus::FunctionCode::ReadHoldingRegisters, 1000, 16)},
+                std::pair{"WriteMultipleRegisters x16, missing addresses", writeMultipleRegistersRequest(1000, 16)}}) {
+            printResult(name, measureNanoseconds(200000, [&]() {
+                Modbus::PDU pdu(std::span<const std::byte>(request), dataArea);
+                if (pdu.buildResponse(response) != 2)
+                    std::abort();
+            }));
+        }
+    }
+
+    /**
+     * Startup cost of a full-size map: 4 tables x 65,536 points, for each value generation type.
+     */
+    void benchmarkFullMapGeneration() {
+        constexpr int size = Modbus::MAX_REGISTER_DATA_AREA_SIZE;
+        for (auto [name, booleanType, integerType]: {
+                std::tuple{"Zeros", Modbus::ValueGenerationType::Zeros, Modbus::ValueGenerationType::Zeros},
+                std::tuple{"Random", Modbus::ValueGenerationType::Random, Modbus::ValueGenerationType::Random},
+                std::tuple{"Incremental", Modbus::ValueGenerationType::Ones,
+                           Modbus::ValueGenerationType::Incremental}}) {
+            auto nanoseconds = measureNanoseconds(5, [&]() {
+                Modbus::DataArea dataArea;
+                dataArea.generateCoils(0, size, booleanType);
+                dataArea.generateDiscreteInputs(0, size, booleanType);
+                dataArea.generateHoldingRegisters(0, size, integerType);
+                dataArea.generateInputRegisters(0, size, integerType);
+            });
+            printResult(std::string("Generate 4 x 65536 points, ") + name, nanoseconds);
+        }
+    }
+
+    /**
+     * Cost of exporting a full-size map: a consistent snapshot of all four tables, and a visit of every point of
+     * the holding register table, compared with copying the same table into register objects with getAll.
+     */
+    void benchmarkFullMapExport() {
+        constexpr int size = Modbus::MAX_REGISTER_DATA_AREA_SIZE;
+        Modbus::DataArea dataArea;
+        dataArea.generateCoils(0, size, Modbus::ValueGenerationType::Random);
+        dataArea.generateDiscreteInputs(0, size, Modbus::ValueGenerationType::Random);
+        dataArea.generateHoldingRegisters(0, size, Modbus::ValueGenerationType::Random);
+        dataArea.generateInputRegisters(0, size, Modbus::ValueGenerationType::Random);
+
+        printResult("Snapshot of 4 x 65536 points", measureNanoseconds(100, [&]() {
+            auto snapshot = dataArea.snapshot();
+            if (snapshot.size(Modbus::TableType::Coils) != size)
+                std::abort();
+        }));
+
+        long checksum = 0;
+        printResult("forEachRange over 65536 holding registers", measureNanoseconds(100, [&]() {
+            dataArea.forEachRange(Modbus::TableType::HoldingRegisters, 0, size,
+                                  [&checksum](int, uint16_t value) { checksum += value; });
+        }));
+        printResult("getAllHoldingRegisters of 65536 registers", measureNanoseconds(100, [&]() {
+            checksum += static_cast<long>(dataArea.getAllHoldingRegisters().size());
+        }));
+        if (checksum == 0)
+            std::cout << "Unexpected empty export" << std::endl;
+    }
+
+    /**
+     * Cost of exporting the changes of a full-size map since the previous export, when nothing changed and when
+     * a handful of scattered registers changed, including the visit of the changed ranges.
+     */
+    void benchmarkDeltaExport() {
+        constexpr int size = Modbus::MAX_REGISTER_DATA_AREA_SIZE;
+        Modbus::DataArea dataArea;
+        dataArea.generateCoils(0, size);
+        dataArea.generateDiscreteInputs(0, size);
+        dataArea.generateHoldingRegisters(0, size);
+        dataArea.generateInputRegisters(0, size);
+        auto version = dataArea.collectChanges(0).version;
+
+        printResult("collectChanges of 4 x 65536 points, no change", measureNanoseconds(10000, [&]() {
+            version = dataArea.collectChanges(version).version;
+        }));
+
+        long checksum = 0;
+        uint16_t value = 0;
+        printResult("16 scattered writes, then collectChanges and export", measureNanoseconds(10000, [&]() {
+            for (int i = 0; i < 16; ++i) {
+                ++value;
+                dataArea.writeSingleRegister((i * 4099 + value) % size, value);
+            }
+            auto changeSet = dataArea.collectChanges(version);
+            for (const auto &change: changeSet.changes)
+                dataArea.forEachRange(change.table, change.start, change.count,
+                                      [&checksum](int, uint16_t registerValue) { checksum += registerValue; });
+            version = changeSet.version;
+        }));
+        if (checksum == 0)
+            std::cout << "Unexpected empty export" << std::endl;
+    }
+
+    /**
+     * Startup cost of a full-size map kept in a memory-mapped file: reopening the file written by a previous run,
+     * compared with generating the map again, and the cost of flushing it after a write.
+     */
+    void benchmarkMappedFileStartup() {
+        constexpr int size = Modbus::MAX_REGISTER_DATA_AREA_SIZE;
+        auto file = std::filesystem::temp_directory_path() / "dataAreaBenchmarks.mbdata";
+        std::filesystem::remove(file);
+        Modbus::MappedFileOptions options{std::chrono::milliseconds(0)};
+        {
+            Modbus::DataArea dataArea(file, options);
+            dataArea.generateCoils(0, size, Modbus::ValueGenerationType::Random);
+            dataArea.generateDiscreteInputs(0, size, Modbus::ValueGenerationType::Random);
+            dataArea.generateHoldingRegisters(0, size, Modbus::ValueGenerationType::Random);
+            dataArea.generateInputRegisters(0, size, Modbus::ValueGenerationType::Random);
+        }
+
+        printResult("Reopen mapped file of 4 x 65536 points", measureNanoseconds(20, [&]() {
+            Modbus::DataArea dataArea(file, options);
+            std::array<uint16_t, 1> value{};
+            dataArea.readHoldingRegisters(size - 1, value);
+        }));
+        printResult("Generate 4 x 65536 points on the heap", measureNanoseconds(20, [&]() {
+            Modbus::DataArea dataArea;
+            dataArea.generateCoils(0, size, Modbus::ValueGenerationType::Random);
+            dataArea.generateDiscreteInputs(0, size, Modbus::ValueGenerationType::Random);
+            dataArea.generateHoldingRegisters(0, size, Modbus::ValueGenerationType::Random);
+            dataArea.generateInputRegisters(0, size, Modbus::ValueGenerationType::Random);
+        }));
+
+        Modbus::DataArea dataArea(file, options);
+        uint16_t value = 0;
+        printResult("writeSingleRegister, then flush of the mapped file", measureNanoseconds(100, [&]() {
+            ++value;
+            dataArea.writeSingleRegister(value % size, value);
+            dataArea.flush();
+        }));
+        std::filesystem::remove(file);
+    }
+
+    /**
+     * Throughput of 16 reader threads polling a block of holding registers while 2 writer threads rewrite it, the
+     * read-mostly mix of a server answering SCADA pollers. Every write stores one value in the whole block, so a
+     * read that sees mixed values has observed a torn write.
+     */
+    void benchmarkReadersAgainstWriters() {
+        constexpr int readerCount = 16;
+        constexpr int writerCount = 2;
+        constexpr auto duration = std::chrono::seconds(2);
+        Modbus::DataArea dataArea;
+        dataArea.generateHoldingRegisters(0, Modbus::MAX_HOLDING_REGISTERS);
+
+        std::atomic<bool> stopFlag{false};
+        std::atomic<long> reads{0};
+        std::atomic<long> writes{0};
+        std::atomic<long> tornReads{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < readerCount; ++i) {
+            threads.emplace_back([&]() {
+                std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+                long count = 0;
+                while (!stopFlag.load(std::memory_order_relaxed)) {
+                    dataArea.readHoldingRegisters(0, values);
+                    if (std::any_of(values.begin(), values.end(), [&](uint16_t v) { return v != values[0]; }))
+                        ++tornReads;
+                    ++count;
+                }
+                reads += count;
+            });
+        }
+        for (int i = 0; i < writerCount; ++i) {
+            threads.emplace_back([&, i]() {
+                std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+                long count = 0;
+                while (!stopFlag.load(std::memory_order_relaxed)) {
+                    values.fill(static_cast<uint16_t>(count * writerCount + i));
+                    dataArea.writeHoldingRegisters(0, values);
+                    ++count;
+                }
+                writes += count;
+            });
+        }
+
+        std::this_thread::sleep_for(duration);
+        stopFlag = true;
+        for (auto &thread: threads)
+            thread.join();
+
+        auto seconds = std::chrono::duration<double>(duration).count();
+        std::cout << std::left << std::setw(60) << "16 readers / 2 writers, holding registers x123" << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(0) << reads / seconds << " reads/s"
+                  << std::setw(12) << writes / seconds << " writes/s" << std::setw(8) << tornReads << " torn"
+                  << std::endl;
+    }
+
+    /**
+     * @brief Runs every operation in a loop on its own thread for the given duration and returns how many times
+     * each of them completed.
+     */
+    std::vector<long> runConcurrently(const std::vector<std::function<void()>> &operations,
+                                      std::chrono::seconds duration) {
+        std::atomic<bool> stopFlag{false};
+        std::vector<long> counts(operations.size());
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < operations.size(); ++i) {
+            threads.emplace_back([&, i]() {
+                long count = 0;
+                while (!stopFlag.load(std::memory_order_relaxed)) {
+                    operations[i]();
+                    ++count;
+                }
+                counts[i] = count;
+            });
+        }
+        std::this_thread::sleep_for(duration);
+        stopFlag = true;
+        for (auto &thread: threads)
+            thread.join();
+        return counts;
+    }
+
+    /**
+     * Traffic spread over the four tables: for each table one writer, standing in for the field side or a SCADA
+     * client writing, and three pollers. Writers of different tables do not share a lock.
+     */
+    void benchmarkMixedTableTraffic() {
+        constexpr int readersPerTable = 3;
+        constexpr auto duration = std::chrono::seconds(2);
+        Modbus::DataArea dataArea;
+        dataArea.generateCoils(0, Modbus::MAX_COILS);
+        dataArea.generateDiscreteInputs(0, Modbus::MAX_DISCRETE_INPUTS);
+        dataArea.generateHoldingRegisters(0, Modbus::MAX_HOLDING_REGISTERS);
+        dataArea.generateInputRegisters(0, Modbus::MAX_INPUT_REGISTERS);
+
+        auto packedWrite = std::make_shared<std::array<std::byte, Modbus::MAX_COILS / 8>>();
+        auto registerWrite = std::make_shared<std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS>>();
+        std::vector<std::function<void()>> writers{
+                [&dataArea, packedWrite]() { dataArea.writeCoils(0, Modbus::MAX_COILS, *packedWrite); },
+                [&dataArea, packedWrite]() {
+                    dataArea.writeDiscreteInputs(0, Modbus::MAX_DISCRETE_INPUTS, *packedWrite);
+                },
+                [&dataArea, registerWrite]() { dataArea.writeHoldingRegisters(0, *registerWrite); },
+                [&dataArea, registerWrite]() { dataArea.writeInputRegisters(0, *registerWrite); }};
+        std::vector<std::function<void()>> readers{
+                [&dataArea, packed = std::array<std::byte, Modbus::MAX_COILS / 8>{}]() mutable {
+                    dataArea.readCoils(0, Modbus::MAX_COILS, packed);
+                },
+                [&dataArea, packed = std::array<std::byte, Modbus::MAX_DISCRETE_INPUTS / 8>{}]() mutable {
+                    dataArea.readDiscreteInputs(0, Modbus::MAX_DISCRETE_INPUTS, packed);
+                },
+                [&dataArea, values = std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS>{}]() mutable {
+                    dataArea.readHoldingRegisters(0, values);
+                },
+                [&dataArea, values = std::array<uint16_t, Modbus::MAX_INPUT_REGISTERS>{}]() mutable {
+                    dataArea.readInputRegisters(0, values);
+                }};
+
+        auto operations = writers;
+        for (int i = 0; i < readersPerTable; ++i)
+            operations.insert(operations.end(), readers.begin(), readers.end());
+        auto counts = runConcurrently(operations, duration);
+
+        auto seconds = std::chrono::duration<double>(duration).count();
+        long writes = std::accumulate(counts.begin(), counts.begin() + 4, 0L);
+        long reads = std::accumulate(counts.begin() + 4, counts.end(), 0L);
+        std::cout << std::left << std::setw(60) << "4 tables x (1 writer + 3 readers)" << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(0) << reads / seconds << " reads/s"
+                  << std::setw(12) << writes / seconds << " writes/s" << std::endl;
+    }
+
+    /**
+     * Four writers of the same holding register table, each in its own stripe, the pattern of several field-side
+     * processes updating distant blocks of a large map.
+     */
+    void benchmarkStripedWriters() {
+        constexpr int writerCount = 4;
+        constexpr auto duration = std::chrono::seconds(2);
+        constexpr int stripeSize = Modbus::StripedSequenceLock::STRIPE_SIZE;
+        Modbus::DataArea dataArea;
+        dataArea.generateHoldingRegisters(0, writerCount * stripeSize);
+
+        std::vector<std::function<void()>> writers;
+        for (int i = 0; i < writerCount; ++i) {
+            writers.emplace_back([&dataArea, i, values = std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS>{}]() {
+                dataArea.writeHoldingRegisters(i * stripeSize, values);
+            });
+        }
+        auto counts = runConcurrently(writers, duration);
+
+        auto seconds = std::chrono::duration<double>(duration).count();
+        std::cout << std::left << std::setw(60) << "4 writers, one holding register table, distinct stripes"
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(0)
+                  << std::accumulate(counts.begin(), counts.end(), 0L) / seconds << " writes/s" << std::endl;
+    }
+}
+
+int main() {
+    benchmarkWriteMultipleRegistersByMapSize();
+    benchmarkWriteMultipleCoils();
+    benchmarkWriteMultipleRegistersBySubscriberCount();
+    benchmarkInvalidAddressRequests();
+    benchmarkFullMapGeneration();
+    benchmarkFullMapExport();
+    benchmarkDeltaExport();
+    benchmarkMappedFileStartup();
+    benchmarkReadersAgainstWriters();
+    benchmarkMixedTableTraffic();
+    benchmarkStripedWriters();
+    return 0;
+}
@@ -0,0 +1,170 @@
+//
+// Load test for Modbus::Server::MBServer: requests and connections per second served over loopback TCP for growing
+// worker counts in both accept modes.
+//
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <ModbusDataArea.h>
+#include <ModbusPDU.h>
+#include <ModbusServer.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using boost::asio::ip::tcp;
+
+    constexpr int CLIENT_CONNECTIONS = 16;
+    constexpr int PIPELINE_DEPTH = 16;
+    constexpr auto TEST_DURATION = std::chrono::seconds(2);
+
+    void printResult(const std::string &name, double operationsPerSecond) {
+        std::cout << std::left << std::setw(72) << name << std::right << std::setw(12) << std::fixed
+                  << std::setprecision(0) << operationsPerSecond << " op/s" << std::endl;
+    }
+
+    /**
+     * @brief Builds PIPELINE_DEPTH back-to-back Read Holding Registers ADUs for 10 registers at address 0.
+     */
+    std::vector<std::byte> pipelinedReadRequests() {
+        std::vector<std::byte> requests;
+        for (int i = 0; i < PIPELINE_DEPTH; ++i) {
+            auto [transactionMSB, transactionLSB] = Modbus::Utilities::uint16ToTwoBytes(static_cast<uint16_t>(i));
+            std::array<std::byte, 12> request{transactionMSB, transactionLSB, std::byte{0x00}, std::byte{0x00},
+                                              std::byte{0x00}, std::byte{0x06}, std::byte{0x01},
+                                              static_cast<std::byte>(Modbus::FunctionCode::ReadHoldingRegisters),
+                                              std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x0A}};
+            requests.insert(requests.end(), request.begin(), request.end());
+        }
+        return requests;
+    }
+
+    /**
+     * @brief Sends pipelined batches over one connection to endpoint until stopFlag is set and returns the requests
+     * answered.
+     */
+    long runClient(const tcp::endpoint &endpoint, const std::atomic<bool> &stopFlag) {
+        boost::asio::io_context ioContext;
+        tcp::socket socket(ioContext);
+        socket.connect(endpoint);
+        socket.set_option(tcp::no_delay(true));
+
+        auto requests = pipelinedReadRequests();
+        // Each response is the 7-byte MBAP header, the function code, the byte count and 10 registers
+        std::vector<std::byte> responses(PIPELINE_DEPTH * (Modbus::MBAP_HEADER_LENGTH + 2 + 20));
+        long answered = 0;
+        while (!stopFlag.load(std::memory_order_relaxed)) {
+            boost::asio::write(socket, boost::asio::buffer(requests));
+            boost::asio::read(socket, boost::asio::buffer(responses));
+            answered += PIPELINE_DEPTH;
+        }
+        return answered;
+    }
+
+    /**
+     * @brief Opens a connection to endpoint, sends a single request, reads its response and closes, until stopFlag
+     * is set.
+     * Returns the number of connections served.
+     */
+    long runShortLivedClient(const tcp::endpoint &endpoint, const std::atomic<bool> &stopFlag) {
+        boost::asio::io_context ioContext;
+        auto request = pipelinedReadRequests();
+        std::vector<std::byte> response(Modbus::MBAP_HEADER_LENGTH + 2 + 20);
+        long served = 0;
+        while (!stopFlag.load(std::memory_order_relaxed)) {
+            tcp::socket socket(ioContext);
+            socket.connect(endpoint);
+            boost::asio::write(socket, boost::asio::buffer(request.data(), request.size() / PIPELINE_DEPTH));
+            boost::asio::read(socket, boost::asio::buffer(response));
+            ++served;
+        }
+        return served;
+    }
+
+    std::string acceptModeName(Modbus::Server::AcceptMode acceptMode) {
+        return acceptMode == Modbus::Server::AcceptMode::SharedAcceptor ? "shared acceptor" : "SO_REUSEPORT";
+    }
+
+    /**
+     * @brief Runs CLIENT_CONNECTIONS client threads against a server for TEST_DURATION and returns the operations
+     * completed per second.
+     */
+    template<typename Client>
+    double measureThroughput(Modbus::DataArea &dataArea, unsigned int workers,
+                             Modbus::Server::AcceptMode acceptMode, Client &&client) {
+        Modbus::Server::ServerOptions options;
+        options.endpoints = {tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)};
+        options.workerThreads = workers;
+        options.acceptMode = acceptMode;
+        Modbus::Server::MBServer server(dataArea, options);
+        auto endpoint = server.localEndpoints().front();
+        std::thread serverThread([&server]() { server.start(); });
+
+        std::atomic<bool> stopFlag{false};
+        std::atomic<long> completed{0};
+        std::vector<std::thread> clients;
+        for (int i = 0; i < CLIENT_CONNECTIONS; ++i)
+            clients.emplace_back([&]() { completed += client(endpoint, stopFlag); });
+
+        auto begin = Clock::now();
+        std::this_thread::sleep_for(TEST_DURATION);
+        stopFlag = true;
+        for (auto &thread: clients)
+            thread.join();
+        auto elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        server.stop();
+        serverThread.join();
+        return static_cast<double>(completed) / elapsed;
+    }
+
+    /**
+     * Requests per second for a fixed set of pipelining clients while the server worker count grows.
+     * Scaling is bounded by the cores available to the server and the clients together.
+     */
+    void benchmarkRequestsPerSecondByWorkerCount() {
+        Modbus::DataArea dataArea;
+        dataArea.generateHoldingRegisters(0, 10, Modbus::ValueGenerationType::Random);
+
+        for (auto acceptMode: {Modbus::Server::AcceptMode::SharedAcceptor,
+                               Modbus::Server::AcceptMode::ReusePortPerWorker}) {
+            for (unsigned int workers: {1U, 2U, 4U, 8U}) {
+                auto requestsPerSecond = measureThroughput(dataArea, workers, acceptMode, runClient);
+                printResult("ReadHoldingRegisters, " + std::to_string(CLIENT_CONNECTIONS) + " connections, " +
+                            std::to_string(workers) + " worker(s), " + acceptModeName(acceptMode),
+                            requestsPerSecond);
+            }
+        }
+    }
+
+    /**
+     * Connections per second for clients that connect, poll once and disconnect, the load pattern that
+     * AcceptMode::ReusePortPerWorker targets.
+     */
+    void benchmarkShortLivedConnectionsByWorkerCount() {
+        Modbus::DataArea dataArea;
+        dataArea.generateHoldingRegisters(0, 10, Modbus::ValueGenerationType::Random);
+
+        for (auto acceptMode: {Modbus::Server::AcceptMode::SharedAcceptor,
+                               Modbus::Server::AcceptMode::ReusePortPerWorker}) {
+            for (unsigned int workers: {1U, 2U, 4U, 8U}) {
+                auto connectionsPerSecond = measureThroughput(dataArea, workers, acceptMode, runShortLivedClient);
+                printResult("Short-lived connections, " + std::to_string(workers) + " worker(s), " +
+                            acceptModeName(acceptMode), connectionsPerSecond);
+            }
+        }
+    }
+}
+
+int main() {
+    std::cout << "Hardware concurrency: " << std::thread::hardware_concurrency() << std::endl;
+    benchmarkRequestsPerSecondByWorkerCount();
+    benchmarkShortLivedConnectionsByWorkerCount();
+    return 0;
+}
@@ -20,12 +20,14 @@ int main() {
             std::cout << std::left << std::setw(10) << "Address" << std::setw(10) << "Coils" << std::setw(20)
                       << "Discrete Inputs" << std::setw(20)
                       << "Holding Registers" << std::setw(20) << "Input Registers" << std::endl;
+            // Every screen shows the tables as they were at a single point in time
+            auto snapshot = dataArea.snapshot();
             for (int i = 0; i < 16; i++) {
-                std::cout << std::setw(10) << i << std::setw(10) << (dataArea.getCoils(i, 1)[0].read() ? "1" : "0")
-                          << std::setw(20)
-                          << (dataArea.getDiscreteInputs(i, 1)[0].read() ? "1" : "0") << std::setw(20)
-                          << dataArea.getHoldingRegisters(i, 1)[0].read() << std::setw(20)
-                          << dataArea.getInputRegisters(i, 1)[0].read() << std::endl;
+                std::cout << std::setw(10) << i << std::setw(10)
+                          << snapshot.value(Modbus::TableType::Coils, i) << std::setw(20)
+                          << snapshot.value(Modbus::TableType::DiscreteInputs, i) << std::setw(20)
+                          << snapshot.value(Modbus::TableType::HoldingRegisters, i) << std::setw(20)
+                          << snapshot.value(Modbus::TableType::InputRegisters, i) << std::endl;
 //                std::cout << std::endl;
                 std::this_thread::sleep_for(std::chrono::milliseconds(500));
             }
@@ -172,34 +172,43 @@ namespace Modbus {
      * Each register has an address which can be accessed using the getAddress() method.
      * The value stored in the register can be accessed using the read() method, and can be modified using the write() method.
      *
+     * A register only holds its address and value: the prefix of its table is a compile-time constant and the
+     * methods are not virtual, so registers are trivially copyable and a vector of them can be copied with memcpy.
+     * Code that needs to handle registers of different types through one interface can wrap them in a
+     * PolymorphicRegister.
+     *
      * @tparam T The data type of the register value.
+     * @tparam Prefix The digit identifying the register table in prefixed addresses, e.g. '4' for holding registers.
      */
-    template<typename T>
+    template<typename T, char Prefix>
     class Register {
     public:
+        using ValueType = T;
+
+        /**
+         * @brief The digit identifying the register table in prefixed addresses.
+         */
+        static constexpr char PREFIX = Prefix;
 
-        virtual ~Register() = default;
+        constexpr Register(int address, T value) : _address(address), _value(value) {}
 
         /**
          * @brief Reads the value of a Modbus register.
          *
-         * This function reads the value of a Modbus register.
-         * It is a pure virtual function, which means that it is
-         * declared in an abstract base class (interface) and must
-         * be implemented in the derived classes.
-         *
          * @return The value of the Modbus register.
          */
-        virtual T read() = 0;
+        constexpr T read() const {
+            return _value;
+        }
 
         /**
-         * @brief Pure virtual function to write a value to a Modbus register.
-         * @tparam T The data type of the value to write.
+         * @brief Writes a value to a Modbus register.
+         *
          * @param value The value to write to the register.
-         * @note This function needs to be implemented by derived classes.
-         * @note The implementation should handle the writing operation to the specific Modbus register.
          */
-        virtual void write(T value) = 0;
+        constexpr void write(T value) {
+            _value = value;
+        }
 
         /**
          * @brief Returns the address of the Modbus register.
@@ -215,89 +224,31 @@ namespace Modbus {
          * int address = coil1.getAddress(); // returns 1
          * @endcode
          */
-        int getAddress() const;
+        constexpr int getAddress() const {
+            return _address;
+        }
 
         /**
-         * @brief Get the address with the given prefix.
-         *
-         * This method returns the address with the specified prefix.
-         * The prefix can be any string that is a valid address prefix.
-         *
-         * @note This method does not modify the original address.
-         *
-         * @return std::string The address with the specified prefix.
-         *
-         * @par Example
-         * @code{.cpp}
-         * Coil coil1(1, true);
-         * std::string address = coil1.getAddressWithPrefix(); // returns "COIL00001" for prefix = "COIL"
-         * @endcode
-         */
-        std::string getAddressWithPrefix() const;
-
-        /**
-         * @brief Returns the address with a hex prefix.
-         *
-         * This function is used to get the address of an object with a hex prefix.
-         * The address is a unique identifier representing the location of the object
-         * in the memory.
-         *
-         * @return The address with a hex prefix.
-         *
-         * @par Example
-         * @code{.cpp}
-         * Coil coil1(1, true);
-         * std::string address = coil1.getAddressWithHexPrefix(); // returns "0x00001" for hex prefix
-         * @endcode
-         */
-        std::string getAddressWithHexPrefix() const;
-
-    protected:
-        std::string _prefix;
-        int _address{};
-        T _value;
-    };
-
-    /**
-         * @brief Returns the address of the Modbus register.
-         *
-         * @tparam T The data type of the Modbus register.
-         * @return int The address of the Modbus register.
-         *
-         * @par Example
-         * @code{.cpp}
-         * Coil coil1(1, true);
-         * int address = coil1.getAddress(); // returns 1
-         * @endcode
-         */
-    template<typename T>
-    int Register<T>::getAddress() const {
-        return _address;
-    }
-
-    /**
          * @brief Get the address of the Register with a prefix.
          *        The address is filled with leading zeros to have a total length of 5 characters.
-         *        If _useHexPrefix is true, the prefix will have an "x" appended to it.
          *
          * @return The address with prefix as a string.
          *
          * @par Example
          * @code{.cpp}
          * Coil coil1(1, true);
-         * std::string address = coil1.getAddressWithPrefix(); // returns "COIL00001" for prefix = "COIL"
+         * std::string address = coil1.getAddressWithPrefix(); // returns "000001"
          * @endcode
          */
-    template<typename T>
-    std::string Register<T>::getAddressWithPrefix() const {
-        return _prefix + fillWithZeros(_address, 5);
-    }
+        std::string getAddressWithPrefix() const {
+            return Prefix + fillWithZeros(_address, 5);
+        }
 
-    /**
+        /**
          * @brief Retrieves the address with a hexadecimal prefix.
          *
-         * This function returns the Modbus register's address, formatted as a string with a hexadecimal prefix. The address is obtained by concatenating the prefix stored in the `_prefix` member
-         * variable with the address converted to a string with leading zeros added to match the desired length, which is 5 in this case.
+         * This function returns the Modbus register's address, formatted as a string with a hexadecimal prefix: the
+         * prefix of the register table, an "x", and the address with leading zeros added to a length of 5.
          *
          * @return The Modbus register's address formatted as a string with a hexadecimal prefix.
          *
@@ -307,12 +258,16 @@ namespace Modbus {
          * std::string address = coil1.getAddressWithHexPrefix(); // returns "0x00001" for hex prefix
          * @endcode
          */
-    template<typename T>
-    std::string Register<T>::getAddressWithHexPrefix() const {
-        return _prefix + "x" + fillWithZeros(_address, 5);
-    }
+        std::string getAddressWithHexPrefix() const {
+            return Prefix + ("x" + fillWithZeros(_address, 5));
+        }
 
-    class Coil final : public Register<bool> {
+    protected:
+        int _address;
+        T _value;
+    };
+
+    class Coil final : public Register<bool, '0'> {
     public:
         /**
          * @class Coil
@@ -324,44 +279,14 @@ namespace Modbus {
          * @par Example
          * @code{.cpp}
          * Coil coil1(1, true); // Create a Coil object and initialize it to true
-         * @endcode
-         */
-        Coil(int address, bool value);
-
-        /**
-         * @brief Reads the value of the Coil.
-         *
-         * This function retrieves the value of the Coil and returns it.
-         *
-         * @return bool The value of the Coil.
-         *
-         * @par Example
-         * @code{.cpp}
-         * Coil coil1(1, true); // Create a Coil object and initialize it to true
          * bool coilValue = coil1.read(); // Returns: true
-         * @endcode
-         */
-        bool read() override;
-
-        /**
-         * @brief Writes a boolean value to the Coil object.
-         *
-         * This function updates the value of the Coil object with the specified boolean value.
-         *
-         * @param value The boolean value to be written to the Coil object.
-         *
-         * @note This function overrides the write function from the base class.
-         *
-         * @par Example
-         * @code{.cpp}
-         * Coil coil1(1, true); // Create a Coil object and initialize it to true
          * coil1.write(false); // Updates the value of the coil to false
          * @endcode
          */
-        void write(bool value) override;
+        constexpr Coil(int address, bool value) : Register(address, value) {}
     };
 
-    class DiscreteInput final : public Register<bool> {
+    class DiscreteInput final : public Register<bool, '1'> {
     public:
         /**
          * @class DiscreteInput
@@ -373,44 +298,14 @@ namespace Modbus {
          * @par Example
          * @code{.cpp}
          * DiscreteInput discInput(2, false); // Create a DiscreteInput object and initialize it to false
-         * @endcode
-         */
-        DiscreteInput(int address, bool value);
-
-        /**
-         * @brief Reads the value of the DiscreteInput.
-         *
-         * This function retrieves the value of the DiscreteInput and returns it.
-         *
-         * @return bool The value of the DiscreteInput.
-         *
-         * @par Example
-         * @code{.cpp}
-         * DiscreteInput discInput(2, false); // Create a DiscreteInput object and initialize it to false
          * bool discValue = discInput.read(); // Returns: false
-         * @endcode
-         */
-        bool read() override;
-
-        /**
-         * @brief Writes a boolean value to the DiscreteInput object.
-         *
-         * This function updates the value of the DiscreteInput object with the specified boolean value.
-         *
-         * @param value The boolean value to be written to the DiscreteInput object.
-         *
-         * @note This function overrides the write function from the base class.
-         *
-         * @par Example
-         * @code{.cpp}
-         * DiscreteInput discInput(2, false); // Create a DiscreteInput object and initialize it to false
          * discInput.write(true); // Updates the value of the discrete input to true
          * @endcode
          */
-        void write(bool value) override;
+        constexpr DiscreteInput(int address, bool value) : Register(address, value) {}
     };
 
-    class InputRegister final : public Register<uint16_t> {
+    class InputRegister final : public Register<uint16_t, '3'> {
     public:
         /**
          * @class InputRegister
@@ -422,45 +317,14 @@ namespace Modbus {
          * @par Example
          * @code{.cpp}
          * InputRegister inputReg(3, 2000); // Create a InputRegister object and initialize it to 2000
-         * @endcode
-         */
-        InputRegister(int address, uint16_t value);
-
-        /**
-         * @brief Reads the value of the InputRegister.
-         *
-         * This function overrides the read() function of the base class and returns
-         * the value stored in the InputRegister.
-         *
-         * @return The value stored in the InputRegister.
-         *
-         * @see InputRegister::read()
-         *
-         * @par Example
-         * @code{.cpp}
-         * InputRegister inputReg(3, 2000); // Create a InputRegister object and initialize it to 2000
          * uint16_t inputRegValue = inputReg.read(); // Returns: 2000
-         * @endcode
-         */
-        uint16_t read() override;
-
-        /**
-         * @brief Write a value to the Modbus input register.
-         *
-         * This function is used to write a specified value to the Modbus input register.
-         *
-         * @param value The value to be written to the input register.
-         *
-         * @par Example
-         * @code{.cpp}
-         * InputRegister inputReg(3, 2000); // Create a InputRegister object and initialize it to 2000
          * inputReg.write(3000); // Updates the value of the input register to 3000
          * @endcode
          */
-        void write(uint16_t value) override;
+        constexpr InputRegister(int address, uint16_t value) : Register(address, value) {}
     };
 
-    class HoldingRegister final : public Register<uint16_t> {
+    class HoldingRegister final : public Register<uint16_t, '4'> {
     public:
         /**
          * @class HoldingRegister
@@ -470,37 +334,76 @@ namespace Modbus {
          * @par Example
          * @code{.cpp}
          * HoldingRegister holdReg(4, 5000); // Create a HoldingRegister object and initialize it to 5000
-         * @endcode
-         */
-        HoldingRegister(int address, uint16_t value);
-
-        /**
-         * @brief This function is used to read the value of a Modbus Holding Register.
-         *
-         * @return The value of the Modbus Holding Register.
-         *
-         * @par Example
-         * @code{.cpp}
-         * HoldingRegister holdReg(4, 5000); // Create a HoldingRegister object and initialize it to 5000
          * uint16_t holdRegValue = holdReg.read(); // Returns: 5000
+         * holdReg.write(6000); // Updates the value of the holding register to 6000
          * @endcode
          */
-        uint16_t read() override;
+        constexpr HoldingRegister(int address, uint16_t value) : Register(address, value) {}
+    };
+
+    /**
+     * @class RegisterInterface
+     * @brief A virtual interface over registers holding values of type T, for code that needs dynamic dispatch.
+     *
+     * The register types themselves have no vtable; see PolymorphicRegister.
+     */
+    template<typename T>
+    class RegisterInterface {
+    public:
+        virtual ~RegisterInterface() = default;
+
+        virtual T read() const = 0;
+
+        virtual void write(T value) = 0;
+
+        virtual int getAddress() const = 0;
+
+        virtual std::string getAddressWithPrefix() const = 0;
+    };
+
+    /**
+     * @class PolymorphicRegister
+     * @brief Holds a register of type R behind a RegisterInterface.
+     *
+     * @par Example
+     * @code{.cpp}
+     * std::vector<std::unique_ptr<RegisterInterface<bool>>> points;
+     * points.push_back(std::make_unique<PolymorphicRegister<Coil>>(Coil(1, true)));
+     * points.push_back(std::make_unique<PolymorphicRegister<DiscreteInput>>(DiscreteInput(2, false)));
+     * @endcode
+     */
+    template<typename R>
+    class PolymorphicRegister final : public RegisterInterface<typename R::ValueType> {
+    public:
+        using ValueType = typename R::ValueType;
+
+        explicit PolymorphicRegister(R reg) : _register(reg) {}
+
+        ValueType read() const override {
+            return _register.read();
+        }
+
+        void write(ValueType value) override {
+            _register.write(value);
+        }
+
+        int getAddress() const override {
+            return _register.getAddress();
+        }
+
+        std::string getAddressWithPrefix() const override {
+            return _register.getAddressWithPrefix();
+        }
 
         /**
-         * @brief Writes a value to the Modbus Holding Register.
-         *
-         * This function overrides the write() function from the base class. It sets the value of the Modbus Holding Register to the specified value.
-         *
-         * @param value The value to write to the Modbus Holding Register.
-         *
-         * @par Example
-         * @code{.cpp}
-         * HoldingRegister holdReg(4, 5000); // Create a HoldingRegister object and initialize it to 5000
-         * holdReg.write(6000); // Updates the value of the holding register to 6000
-         * @endcode
+         * @brief Returns the wrapped register.
          */
-        void write(uint16_t value) override;
+        const R &get() const {
+            return _register;
+        }
+
+    private:
+        R _register;
     };
 }
 
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <stdexcept>
+#include "ModbusAsyncClient.h"
+#include "ModbusFrameAssembler.h"
+
+namespace {
+    using Signal = boost::asio::steady_timer;
+
+    /**
+     * @brief Waits until the timer expires or is cancelled. The window and write signals never expire, so they
+     * are only woken by a cancellation.
+     */
+    boost::asio::awaitable<void> waitFor(Signal &signal) {
+        boost::system::error_code ignored;
+        co_await signal.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+    }
+
+    std::span<std::byte> pduOf(std::span<std::byte> adu) {
+        return adu.subspan(Modbus::MBAP_HEADER_LENGTH);
+    }
+}
+
+/**
+ * @brief A request in flight, owned by the coroutine that sent it.
+ */
+struct Modbus::AsyncClient::Transaction {
+    explicit Transaction(const boost::asio::any_io_executor &executor) : signal(executor) {}
+
+    uint16_t identifier = 0;
+    uint8_t unitIdentifier = 0;
+    std::span<std::byte> adu;
+    std::size_t pduLength = 0;
+
+    // Set once the response or the failure of the connection is delivered, and the signal cancelled
+    bool answered = false;
+    std::size_t responseLength = 0;
+    std::exception_ptr error;
+    Signal signal;
+};
+
+struct Modbus::AsyncClient::Connection {
+    explicit Connection(const boost::asio::any_io_executor &executor)
+            : socket(executor), windowSignal(executor, Signal::time_point::max()),
+              writeSignal(executor, Signal::time_point::max()) {}
+
+    boost::asio::ip::tcp::socket socket;
+    FrameAssembler responses;
+    std::vector<Transaction *> inFlight;
+    std::exception_ptr failure;
+
+    bool writing = false;
+    Signal windowSignal; // Cancelled once for every place freed in the window
+    Signal writeSignal;  // Cancelled once every time the socket is free for writing
+
+    /**
+     * @brief Hands a response frame to the request in flight with its transaction identifier.
+     */
+    void dispatch(std::span<const std::byte> frame) {
+        auto [mbap, response] = ClientProtocol::splitResponseFrame(frame);
+        auto found = std::find_if(inFlight.begin(), inFlight.end(), [&mbap](const Transaction *transaction) {
+            return transaction->identifier == mbap.transactionIdentifier;
+        });
+        if (found == inFlight.end())
+            return; // A late response to a request that timed out
+        auto &transaction = **found;
+        inFlight.erase(found);
+
+        try {
+            if (mbap.unitIdentifier != transaction.unitIdentifier)
+                throw std::runtime_error("Response does not match the request.");
+            ClientProtocol::checkResponse(pduOf(transaction.adu).first(transaction.pduLength), response);
+            std::copy(response.begin(), response.end(), pduOf(transaction.adu).begin());
+            transaction.responseLength = response.size();
+        } catch (...) {
+            transaction.error = std::current_exception();
+        }
+        transaction.answered = true;
+        transaction.signal.cancel();
+    }
+
+    /**
+     * @brief Closes the connection and fails the requests in flight and the requests waiting to be sent.
+     */
+    void fail(std::exception_ptr error) {
+        if (failure)
+            return;
+        failure = std::move(error);
+        boost::system::error_code ignored;
+        socket.close(ignored);
+        for (auto *transaction: inFlight) {
+            transaction->error = failure;
+            transaction->answered = true;
+            transaction->signal.cancel();
+        }
+        inFlight.clear();
+        windowSignal.cancel();
+        writeSignal.cancel();
+    }
+};
+
+Modbus::AsyncClient::AsyncClient(boost::asio::any_io_executor executor, std::string ip, int port,
+                                 uint8_t unitIdentifier, AsyncClientOptions options)
+        : _executor(std::move(executor)), _ip(std::move(ip)), _port(port), _unitIdentifier(unitIdentifier),
+          _options(options) {
+    if (_options.window == 0)
+        throw std::invalid_argument("The request window must hold at least one request.");
+}
+
+Modbus::AsyncClient::~AsyncClient() {
+    disconnect();
+}
+
+boost::asio::awaitable<void> Modbus::AsyncClient::connect() {
+    auto connection = std::make_shared<Connection>(_executor);
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(_ip), _port);
+    co_await connection->socket.async_connect(endpoint, boost::asio::use_awaitable);
+    connection->socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+    disconnect();
+    _connection = connection;
+    boost::asio::co_spawn(_executor, receive(std::move(connection)), boost::asio::detached);
+}
+
+void Modbus::AsyncClient::disconnect() {
+    if (_connection)
+        _connection->fail(std::make_exception_ptr(boost::system::system_error(boost::asio::error::operation_aborted)));
+}
+
+boost::asio::any_io_executor Modbus::AsyncClient::executor() {
+    return _executor;
+}
+
+boost::asio::awaitable<std::vector<bool>> Modbus::AsyncClient::readCoils(uint16_t startAddress, uint16_t quantity) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    auto length = ClientProtocol::buildReadRequest(pduOf(adu), FunctionCode::ReadCoils, startAddress, quantity);
+    co_return ClientProtocol::decodeBits(co_await transact(adu, length), quantity);
+}
+
+boost::asio::awaitable<std::vector<bool>>
+Modbus::AsyncClient::readDiscreteInputs(uint16_t startAddress, uint16_t quantity) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    auto length = ClientProtocol::buildReadRequest(pduOf(adu), FunctionCode::ReadDiscreteInputs, startAddress,
+                                                   quantity);
+    co_return ClientProtocol::decodeBits(co_await transact(adu, length), quantity);
+}
+
+boost::asio::awaitable<std::vector<uint16_t>>
+Modbus::AsyncClient::readHoldingRegisters(uint16_t startAddress, uint16_t quantity) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    auto length = ClientProtocol::buildReadRequest(pduOf(adu), FunctionCode::ReadHoldingRegisters, startAddress,
+                                                   quantity);
+    co_return ClientProtocol::decodeRegisters(co_await transact(adu, length), quantity);
+}
+
+boost::asio::awaitable<std::vector<uint16_t>>
+Modbus::AsyncClient::readInputRegisters(uint16_t startAddress, uint16_t quantity) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    auto length = ClientProtocol::buildReadRequest(pduOf(adu), FunctionCode::ReadInputRegister, startAddress,
+                                                   quantity);
+    co_return ClientProtocol::decodeRegisters(co_await transact(adu, length), quantity);
+}
+
+boost::asio::awaitable<void> Modbus::AsyncClient::writeSingleCoil(uint16_t address, bool value) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    co_await transact(adu, ClientProtocol::buildWriteSingleCoilRequest(pduOf(adu), address, value));
+}
+
+boost::asio::awaitable<void> Modbus::AsyncClient::writeSingleRegister(uint16_t address, uint16_t value) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    co_await transact(adu, ClientProtocol::buildWriteSingleRegisterRequest(pduOf(adu), address, value));
+}
+
+boost::asio::awaitable<void>
+Modbus::AsyncClient::writeMultipleCoils(uint16_t startAddress, uint16_t quantity, std::vector<bool> values) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    co_await transact(adu, ClientProtocol::buildWriteMultipleCoilsRequest(pduOf(adu), startAddress, quantity,
+                                                                          values));
+}
+
+boost::asio::awaitable<void>
+Modbus::AsyncClient::writeMultipleRegisters(uint16_t startAddress, uint16_t quantity, std::vector<uint16_t> values) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    co_await transact(adu, ClientProtocol::buildWriteMultipleRegistersRequest(pduOf(adu), startAddress, quantity,
+                                                                              values));
+}
+
+boost::asio::awaitable<std::vector<uint16_t>> Modbus::AsyncClient::read(const ReadPlan &plan) {
+    std::vector<uint16_t> values(plan.pointCount());
+    co_await read(plan, [&plan, &values](std::size_t request, std::span<const std::byte> response) {
+        plan.scatter(request, response, values);
+    });
+    co_return values;
+}
+
+boost::asio::awaitable<void> Modbus::AsyncClient::read(const ReadPlan &plan, PlanResponseHandler handler) {
+    auto remaining = plan.requests().size();
+    std::exception_ptr failure;
+    Signal completed(_executor, Signal::time_point::max());
+    // The requests run as coroutines of their own so that the window fills; they complete before this frame ends
+    for (std::size_t i = 0; i < plan.requests().size(); ++i) {
+        boost::asio::co_spawn(_executor, readPlanned(plan, i, handler),
+                              [&remaining, &failure, &completed](std::exception_ptr error) {
+                                  if (error && !failure)
+                                      failure = error;
+                                  if (--remaining == 0)
+                                      completed.cancel();
+                              });
+    }
+    if (remaining > 0)
+        co_await waitFor(completed);
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+boost::asio::awaitable<void>
+Modbus::AsyncClient::readPlanned(const ReadPlan &plan, std::size_t request, const PlanResponseHandler &handler) {
+    std::array<std::byte, MAX_ADU_LENGTH> adu{};
+    const auto &planned = plan.requests()[request];
+    auto length = ClientProtocol::buildReadRequest(pduOf(adu), planned.functionCode(), planned.startAddress,
+                                                   planned.quantity);
+    handler(request, co_await transact(adu, length));
+}
+
+boost::asio::awaitable<std::span<const std::byte>>
+Modbus::AsyncClient::transact(std::span<std::byte> adu, std::size_t pduLength) {
+    auto connection = _connection;
+    if (!connection)
+        throw boost::system::system_error(boost::asio::error::not_connected);
+    auto timeout = _options.timeout;
+    while (!connection->failure && connection->inFlight.size() >= _options.window)
+        co_await waitFor(connection->windowSignal);
+    if (connection->failure)
+        std::rethrow_exception(connection->failure);
+
+    Transaction transaction(_executor);
+    transaction.identifier = ++_nextTransaction;
+    transaction.unitIdentifier = _unitIdentifier;
+    transaction.adu = adu;
+    transaction.pduLength = pduLength;
+    writeMBAP({transaction.identifier, 0, static_cast<uint16_t>(pduLength + 1), _unitIdentifier}, adu);
+    connection->inFlight.push_back(&transaction);
+
+    // Gives the place in the window back however the request ends; after a timeout, the late response finds no
+    // request with its transaction identifier and is skipped
+    struct WindowPlace {
+        Connection &connection;
+        Transaction &transaction;
+
+        ~WindowPlace() {
+            std::erase(connection.inFlight, &transaction);
+            connection.windowSignal.cancel_one();
+        }
+    } place{*connection, transaction};
+
+    // Requests are written whole, one at a time
+    while (connection->writing && !transaction.answered)
+        co_await waitFor(connection->writeSignal);
+    if (!transaction.answered) {
+        connection->writing = true;
+        boost::system::error_code error;
+        co_await boost::asio::async_write(connection->socket,
+                                          boost::asio::buffer(adu.data(), MBAP_HEADER_LENGTH + pduLength),
+                                          boost::asio::redirect_error(boost::asio::use_awaitable, error));
+        connection->writing = false;
+        connection->writeSignal.cancel_one();
+        if (error)
+            connection->fail(std::make_exception_ptr(boost::system::system_error(error)));
+    }
+
+    // The response may have been received while the write completed
+    if (!transaction.answered) {
+        transaction.signal.expires_after(timeout);
+        co_await waitFor(transaction.signal);
+    }
+    if (!transaction.answered)
+        throw boost::system::system_error(boost::asio::error::timed_out);
+    if (transaction.error)
+        std::rethrow_exception(transaction.error);
+    co_return pduOf(adu).first(transaction.responseLength);
+}
+
+boost::asio::awaitable<void> Modbus::AsyncClient::receive(std::shared_ptr<Connection> connection) {
+    try {
+        while (!connection->failure) {
+            auto space = connection->responses.prepare();
+            connection->responses.commit(co_await connection->socket.async_read_some(
+                    boost::asio::buffer(space.data(), space.size()), boost::asio::use_awaitable));
+            while (auto frame = ClientProtocol::nextResponseFrame(connection->responses))
+                connection->dispatch(*frame);
+        }
+    } catch (...) {
+        connection->fail(std::current_exception());
+    }
+}
@@ -0,0 +1,198 @@
+#ifndef MBLIBRARY_MODBUSASYNCCLIENT_H
+#define MBLIBRARY_MODBUSASYNCCLIENT_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include "Modbus.h"
+#include "ModbusClientProtocol.h"
+#include "ModbusPDU.h"
+#include "ModbusReadPlan.h"
+
+namespace Modbus {
+
+    /**
+     * @struct AsyncClientOptions
+     * @brief The configuration an AsyncClient is created with.
+     *
+     * The defaults keep the client in lockstep, one request at a time, which every server supports.
+     */
+    struct AsyncClientOptions {
+        /// The number of requests sent on the connection before their responses arrive. Further requests wait for
+        /// a response or a timeout to free a place. Use a window above 1 only with servers that queue requests.
+        std::size_t window = 1;
+
+        /// How long a sent request waits for its response. A request that times out fails with
+        /// boost::asio::error::timed_out; the connection stays open and the late response is skipped.
+        std::chrono::milliseconds timeout{1000};
+    };
+
+    /**
+     * @class AsyncClient
+     * @brief A Modbus/TCP client whose requests are Boost.Asio coroutines.
+     *
+     * The client runs on an executor supplied by the caller and owns no thread or io_context, so thousands of
+     * device connections can share one io_context, each polled by its own coroutines. Requests are framed,
+     * matched and checked as by the blocking Client, and throw the same exceptions from the co_await.
+     *
+     * Several coroutines may send requests on the same client: up to AsyncClientOptions::window of them are in
+     * flight on the connection at once, and responses are matched to their requests by transaction identifier in
+     * whatever order the server sends them. Over a link with a long round trip this multiplies the requests
+     * answered per second by the window. A coroutine of the connection reads the responses from connect() until
+     * the connection fails or is closed, which fails the requests in flight and every later request until the
+     * next connect().
+     *
+     * The executor must not run the handlers of a client concurrently: use an io_context run by a single thread,
+     * or a strand. The client must outlive its requests.
+     *
+     * @par Example
+     * @code{.cpp}
+     * boost::asio::awaitable<void> poll(Modbus::AsyncClient &client) {
+     *     co_await client.connect();
+     *     for (;;) {
+     *         auto values = co_await client.readHoldingRegisters(0, 10);
+     *         ...
+     *     }
+     * }
+     *
+     * boost::asio::io_context context;
+     * Modbus::AsyncClient client(context.get_executor(), "192.168.1.10");
+     * boost::asio::co_spawn(context, poll(client), boost::asio::detached);
+     * context.run();
+     * @endcode
+     */
+    class AsyncClient {
+    public:
+        /**
+         * @param executor The executor running the I/O of the client.
+         * @param ip The IPv4 or IPv6 address of the server.
+         * @param port The TCP port of the server.
+         * @param unitIdentifier The unit identifier sent with every request.
+         * @param options The request window and timeout.
+         * @throws std::invalid_argument if the window is 0.
+         */
+        AsyncClient(boost::asio::any_io_executor executor, std::string ip, int port = 502,
+                    uint8_t unitIdentifier = 1, AsyncClientOptions options = {});
+
+        ~AsyncClient();
+
+        AsyncClient(const AsyncClient &) = delete;
+        AsyncClient &operator=(const AsyncClient &) = delete;
+
+        /**
+         * @brief Opens a new connection, closing the current one if any.
+         *
+         * @throws boost::system::system_error if the connection fails.
+         */
+        boost::asio::awaitable<void> connect();
+
+        /**
+         * @brief Closes the connection; the requests in flight fail with boost::asio::error::operation_aborted.
+         */
+        void disconnect();
+
+        boost::asio::any_io_executor executor();
+
+        /**
+         * @brief Reads quantity coils starting at startAddress.
+         */
+        boost::asio::awaitable<std::vector<bool>> readCoils(uint16_t startAddress, uint16_t quantity);
+
+        boost::asio::awaitable<std::vector<bool>> readDiscreteInputs(uint16_t startAddress, uint16_t quantity);
+
+        boost::asio::awaitable<std::vector<uint16_t>> readHoldingRegisters(uint16_t startAddress, uint16_t quantity);
+
+        boost::asio::awaitable<std::vector<uint16_t>> readInputRegisters(uint16_t startAddress, uint16_t quantity);
+
+        boost::asio::awaitable<void> writeSingleCoil(uint16_t address, bool value);
+
+        boost::asio::awaitable<void> writeSingleRegister(uint16_t address, uint16_t value);
+
+        /**
+         * @brief Writes the first quantity values to the coils starting at startAddress.
+         *
+         * The values are taken by value, as the coroutine may outlive the expression that started it.
+         */
+        boost::asio::awaitable<void>
+        writeMultipleCoils(uint16_t startAddress, uint16_t quantity, std::vector<bool> values);
+
+        /**
+         * @brief Writes the first quantity values to the holding registers starting at startAddress.
+         */
+        boost::asio::awaitable<void>
+        writeMultipleRegisters(uint16_t startAddress, uint16_t quantity, std::vector<uint16_t> values);
+
+        /**
+         * @brief Sends all the requests of a plan, up to the window at a time, and returns the values of its points.
+         *
+         * The plan must outlive the call.
+         *
+         * @return The value of every point of the plan, in the order the points were given; coils and discrete
+         * inputs read as 0 or 1.
+         * @throws ExceptionResponseError, std::runtime_error or boost::system::system_error as the single requests
+         * do: the error of the first request of the plan that failed, once every request has completed.
+         */
+        boost::asio::awaitable<std::vector<uint16_t>> read(const ReadPlan &plan);
+
+        /**
+         * @brief Called with the index of a request of a plan and its checked response PDU, valid during the call.
+         */
+        using PlanResponseHandler = std::function<void(std::size_t request, std::span<const std::byte> response)>;
+
+        /**
+         * @brief Sends all the requests of a plan, up to the window at a time, and hands each response to handler
+         * as it arrives.
+         *
+         * This is the form of read() for callers that copy whole response blocks, such as the PollScheduler
+         * publishing into a DataArea. The plan must outlive the call.
+         *
+         * @throws ExceptionResponseError, std::runtime_error or boost::system::system_error as the single requests
+         * do: the error of the first request of the plan that failed, once every request has completed.
+         */
+        boost::asio::awaitable<void> read(const ReadPlan &plan, PlanResponseHandler handler);
+
+    private:
+        struct Transaction;
+        struct Connection;
+
+        boost::asio::any_io_executor _executor;
+        std::string _ip;
+        int _port;
+        uint8_t _unitIdentifier;
+        AsyncClientOptions _options;
+        uint16_t _nextTransaction = 0;
+
+        // Shared with the coroutine reading the responses, which may still run after the client is destroyed
+        std::shared_ptr<Connection> _connection;
+
+        /**
+         * @brief Sends the request PDU of pduLength bytes built after the MBAP header of adu and waits for its
+         * response.
+         *
+         * adu belongs to the calling coroutine and holds MAX_ADU_LENGTH bytes; the response PDU is copied over the
+         * request once it is checked.
+         *
+         * @return The checked PDU of the response, in adu.
+         * @throws boost::system::system_error if the request times out, or the connection is closed or fails.
+         */
+        boost::asio::awaitable<std::span<const std::byte>> transact(std::span<std::byte> adu, std::size_t pduLength);
+
+        /**
+         * @brief Sends one request of a plan and hands its response to handler.
+         */
+        boost::asio::awaitable<void>
+        readPlanned(const ReadPlan &plan, std::size_t request, const PlanResponseHandler &handler);
+
+        /**
+         * @brief Reads the responses of a connection and hands them to the requests in flight.
+         */
+        static boost::asio::awaitable<void> receive(std::shared_ptr<Connection> connection);
+    };
+}
+
+#endif //MBLIBRARY_MODBUSASYNCCLIENT_H
@@ -1,61 +1,87 @@
 #include "ModbusClient.h"
-#include "ModbusPDU.h"
-#include "ModbusUtilities.h"
 
-Modbus::Client::Client(std::string ip, int port) : _ip(std::move(ip)), _port(port), _socket(_ioContext) {
+Modbus::Client::Client(std::string ip, int port, uint8_t unitIdentifier)
+        : _socket(_ioContext), _ip(std::move(ip)), _port(port), _unitIdentifier(unitIdentifier) {
 }
 
 void Modbus::Client::connect() {
     boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(_ip), _port);
     _socket.connect(endpoint);
+    _socket.set_option(boost::asio::ip::tcp::no_delay(true));
+    _responses = FrameAssembler();
 }
 
 void Modbus::Client::disconnect() {
-
     _socket.close();
 }
 
 std::vector<bool> Modbus::Client::readCoils(uint16_t startAddress, uint16_t quantity) {
-    auto [StartAddressMSB, StartAddressLSB] = Modbus::Utilities::uint16ToTwoBytes(startAddress);
-    auto [QuantityMSB, QuantityLSB] = Modbus::Utilities::uint16ToTwoBytes(quantity);
-    std::vector<std::byte> requestRawData = {static_cast<std::byte>(Modbus::FunctionCode::ReadCoils),
-                                             StartAddressMSB, StartAddressLSB, QuantityMSB, QuantityLSB};
-    auto getResponse = requestDataFromServer(requestRawData);
-    return {};
+    auto length = ClientProtocol::buildReadRequest(requestPDU(), FunctionCode::ReadCoils, startAddress, quantity);
+    return ClientProtocol::decodeBits(requestDataFromServer(length), quantity);
 }
 
 std::vector<bool> Modbus::Client::readDiscreteInputs(uint16_t startAddress, uint16_t quantity) {
-    return {};
+    auto length = ClientProtocol::buildReadRequest(requestPDU(), FunctionCode::ReadDiscreteInputs, startAddress,
+                                                   quantity);
+    return ClientProtocol::decodeBits(requestDataFromServer(length), quantity);
 }
 
 std::vector<uint16_t> Modbus::Client::readHoldingRegisters(uint16_t startAddress, uint16_t quantity) {
-    return {};
+    auto length = ClientProtocol::buildReadRequest(requestPDU(), FunctionCode::ReadHoldingRegisters, startAddress,
+                                                   quantity);
+    return ClientProtocol::decodeRegisters(requestDataFromServer(length), quantity);
 }
 
 std::vector<uint16_t> Modbus::Client::readInputRegisters(uint16_t startAddress, uint16_t quantity) {
-    return {};
+    auto length = ClientProtocol::buildReadRequest(requestPDU(), FunctionCode::ReadInputRegister, startAddress,
+                                                   quantity);
+    return ClientProtocol::decodeRegisters(requestDataFromServer(length), quantity);
 }
 
 void Modbus::Client::writeSingleCoil(uint16_t address, bool value) {
-
+    requestDataFromServer(ClientProtocol::buildWriteSingleCoilRequest(requestPDU(), address, value));
 }
 
 void Modbus::Client::writeSingleRegister(uint16_t address, uint16_t value) {
-
+    requestDataFromServer(ClientProtocol::buildWriteSingleRegisterRequest(requestPDU(), address, value));
 }
 
 void Modbus::Client::writeMultipleCoils(uint16_t startAddress, uint16_t quantity, const std::vector<bool> &values) {
-
+    requestDataFromServer(
+            ClientProtocol::buildWriteMultipleCoilsRequest(requestPDU(), startAddress, quantity, values));
 }
 
 void
 Modbus::Client::writeMultipleRegisters(uint16_t startAddress, uint16_t quantity, const std::vector<uint16_t> &values) {
-
+    requestDataFromServer(
+            ClientProtocol::buildWriteMultipleRegistersRequest(requestPDU(), startAddress, quantity, values));
 }
 
-std::vector<std::byte> Modbus::Client::requestDataFromServer(const std::vector<std::byte> &requestRawData) {
-    return {};
+std::vector<uint16_t> Modbus::Client::read(const ReadPlan &plan) {
+    std::vector<uint16_t> values(plan.pointCount());
+    for (std::size_t i = 0; i < plan.requests().size(); ++i) {
+        const auto &request = plan.requests()[i];
+        auto length = ClientProtocol::buildReadRequest(requestPDU(), request.functionCode(), request.startAddress,
+                                                       request.quantity);
+        plan.scatter(i, requestDataFromServer(length), values);
+    }
+    return values;
 }
 
+std::span<std::byte> Modbus::Client::requestPDU() {
+    return std::span(_request).subspan(MBAP_HEADER_LENGTH);
+}
 
-
+std::span<const std::byte> Modbus::Client::requestDataFromServer(std::size_t pduLength) {
+    auto transaction = ++_nextTransaction;
+    writeMBAP({transaction, 0, static_cast<uint16_t>(pduLength + 1), _unitIdentifier}, _request);
+    boost::asio::write(_socket, boost::asio::buffer(_request.data(), MBAP_HEADER_LENGTH + pduLength));
+
+    auto request = requestPDU().first(pduLength);
+    for (;;) {
+        if (auto response = ClientProtocol::nextResponse(_responses, transaction, _unitIdentifier, request))
+            return *response;
+        auto space = _responses.prepare();
+        _responses.commit(_socket.read_some(boost::asio::buffer(space.data(), space.size())));
+    }
+}
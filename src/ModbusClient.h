@@ -5,19 +5,63 @@
 #ifndef MBLIBRARY_MODBUSCLIENT_H
 #define MBLIBRARY_MODBUSCLIENT_H
 
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
 #include <vector>
 #include <boost/asio.hpp>
 #include "Modbus.h"
+#include "ModbusClientProtocol.h"
+#include "ModbusFrameAssembler.h"
+#include "ModbusPDU.h"
+#include "ModbusReadPlan.h"
 
 namespace Modbus {
+
+    /**
+     * @class Client
+     * @brief A blocking Modbus/TCP client.
+     *
+     * Every request is framed with an MBAP header carrying a new transaction identifier and the unit identifier
+     * of the client, sent in a single write, and answered before the call returns. Responses are matched to the
+     * request by transaction identifier: a late response to an earlier request is skipped. Requests are built in
+     * a buffer owned by the client and responses are read through a FrameAssembler, so the only allocation of a
+     * call is the returned vector.
+     *
+     * Every request function throws std::invalid_argument if its quantity or values do not fit in a single
+     * request, ExceptionResponseError if the server answers with an exception response, std::runtime_error if
+     * the response does not match the request, and boost::system::system_error if the connection fails.
+     *
+     * A Client is not thread-safe; use one per thread or serialize the calls.
+     *
+     * @par Example
+     * @code{.cpp}
+     * Modbus::Client client("192.168.1.10");
+     * client.connect();
+     * auto values = client.readHoldingRegisters(0, 10);
+     * client.writeSingleCoil(3, true);
+     * @endcode
+     */
     class Client {
     public:
-        explicit Client(std::string ip, int port = 502);
-
+        /**
+         * @param ip The IPv4 or IPv6 address of the server.
+         * @param port The TCP port of the server.
+         * @param unitIdentifier The unit identifier sent with every request.
+         */
+        explicit Client(std::string ip, int port = 502, uint8_t unitIdentifier = 1);
+
+        /**
+         * @throws boost::system::system_error if the connection fails.
+         */
         void connect();
 
         void disconnect();
 
+        /**
+         * @brief Reads quantity coils starting at startAddress.
+         */
         std::vector<bool> readCoils(uint16_t startAddress, uint16_t quantity);
 
         std::vector<bool> readDiscreteInputs(uint16_t startAddress, uint16_t quantity);
@@ -30,21 +74,48 @@ namespace Modbus {
 
         void writeSingleRegister(uint16_t address, uint16_t value);
 
+        /**
+         * @brief Writes the first quantity values to the coils starting at startAddress.
+         */
         void writeMultipleCoils(uint16_t startAddress, uint16_t quantity, const std::vector<bool> &values);
 
+        /**
+         * @brief Writes the first quantity values to the holding registers starting at startAddress.
+         */
         void writeMultipleRegisters(uint16_t startAddress, uint16_t quantity, const std::vector<uint16_t> &values);
 
+        /**
+         * @brief Sends the requests of a plan one after the other and returns the values of its points.
+         *
+         * @return The value of every point of the plan, in the order the points were given; coils and discrete
+         * inputs read as 0 or 1.
+         */
+        std::vector<uint16_t> read(const ReadPlan &plan);
+
     private:
         boost::asio::io_context _ioContext;
         boost::asio::ip::tcp::socket _socket;
         std::string _ip;
         int _port;
-
-        std::vector<std::byte> requestDataFromServer(const std::vector<std::byte> &requestRawData);
-
-        bool isRequestValid(const std::vector<std::byte> &requestRawData, FunctionCode functionCode);
+        uint8_t _unitIdentifier;
+        uint16_t _nextTransaction = 0;
+
+        std::array<std::byte, MAX_ADU_LENGTH> _request{};
+        FrameAssembler _responses;
+
+        /**
+         * @brief Returns the PDU part of the request buffer, where requests are built.
+         */
+        std::span<std::byte> requestPDU();
+
+        /**
+         * @brief Sends the PDU of pduLength bytes built in requestPDU() and waits for its response.
+         *
+         * @return The checked PDU of the response, valid until the next request.
+         * @throws ExceptionResponseError if the response is an exception response.
+         */
+        std::span<const std::byte> requestDataFromServer(std::size_t pduLength);
     };
-
+}
 
 #endif //MBLIBRARY_MODBUSCLIENT_H
-}
\ No newline at end of file
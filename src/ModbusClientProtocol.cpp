@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include "ModbusClientProtocol.h"
+#include "ModbusUtilities.h"
+
+namespace {
+    std::string describeException(Modbus::FunctionCode functionCode, Modbus::ExceptionCode exceptionCode) {
+        return "Server answered function " + std::to_string(static_cast<int>(functionCode)) + " with exception " +
+               std::to_string(static_cast<int>(exceptionCode)) + ".";
+    }
+
+    /**
+     * @brief Writes a function code followed by two 16-bit fields, the start of every request of the client.
+     */
+    void writeRequestHeader(std::span<std::byte> pdu, Modbus::FunctionCode functionCode, uint16_t first,
+                            uint16_t second) {
+        pdu[0] = static_cast<std::byte>(functionCode);
+        std::tie(pdu[1], pdu[2]) = Modbus::Utilities::uint16ToTwoBytes(first);
+        std::tie(pdu[3], pdu[4]) = Modbus::Utilities::uint16ToTwoBytes(second);
+    }
+
+    uint16_t requestQuantity(std::span<const std::byte> request) {
+        return Modbus::Utilities::twoBytesToUint16(request[3], request[4]);
+    }
+}
+
+Modbus::ExceptionResponseError::ExceptionResponseError(FunctionCode functionCode, ExceptionCode exceptionCode)
+        : std::runtime_error(describeException(functionCode, exceptionCode)), _functionCode(functionCode),
+          _exceptionCode(exceptionCode) {
+}
+
+Modbus::FunctionCode Modbus::ExceptionResponseError::functionCode() const {
+    return _functionCode;
+}
+
+Modbus::ExceptionCode Modbus::ExceptionResponseError::exceptionCode() const {
+    return _exceptionCode;
+}
+
+std::size_t Modbus::ClientProtocol::buildReadRequest(std::span<std::byte> pdu, FunctionCode functionCode,
+                                                     uint16_t startAddress, uint16_t quantity) {
+    uint16_t maxQuantity;
+    switch (functionCode) {
+        case FunctionCode::ReadCoils:
+        case FunctionCode::ReadDiscreteInputs:
+            maxQuantity = MAX_READ_BITS;
+            break;
+        case FunctionCode::ReadHoldingRegisters:
+        case FunctionCode::ReadInputRegister:
+            maxQuantity = MAX_READ_REGISTERS;
+            break;
+        default:
+            throw std::invalid_argument("Not a read function code.");
+    }
+    if (quantity == 0 || quantity > maxQuantity)
+        throw std::invalid_argument("Invalid quantity for a read request.");
+    writeRequestHeader(pdu, functionCode, startAddress, quantity);
+    return 5;
+}
+
+std::size_t Modbus::ClientProtocol::buildWriteSingleCoilRequest(std::span<std::byte> pdu, uint16_t address,
+                                                                bool value) {
+    writeRequestHeader(pdu, FunctionCode::WriteSingleCoil, address, value ? 0xFF00 : 0x0000);
+    return 5;
+}
+
+std::size_t Modbus::ClientProtocol::buildWriteSingleRegisterRequest(std::span<std::byte> pdu, uint16_t address,
+                                                                    uint16_t value) {
+    writeRequestHeader(pdu, FunctionCode::WriteSingleRegister, address, value);
+    return 5;
+}
+
+std::size_t Modbus::ClientProtocol::buildWriteMultipleCoilsRequest(std::span<std::byte> pdu, uint16_t startAddress,
+                                                                   uint16_t quantity,
+                                                                   const std::vector<bool> &values) {
+    if (quantity == 0 || quantity > MAX_WRITE_BITS || values.size() < quantity)
+        throw std::invalid_argument("Invalid coil quantity for a Write Multiple Coils request.");
+    auto byteCount = calculateBytesFromBits(quantity);
+    writeRequestHeader(pdu, FunctionCode::WriteMultipleCoils, startAddress, quantity);
+    pdu[5] = static_cast<std::byte>(byteCount);
+    auto packed = pdu.subspan(6, byteCount);
+    std::fill(packed.begin(), packed.end(), std::byte{0});
+    for (int i = 0; i < quantity; ++i) {
+        if (values[i])
+            packed[i / 8] |= static_cast<std::byte>(1U << (i % 8));
+    }
+    return 6 + byteCount;
+}
+
+std::size_t Modbus::ClientProtocol::buildWriteMultipleRegistersRequest(std::span<std::byte> pdu,
+                                                                       uint16_t startAddress, uint16_t quantity,
+                                                                       const std::vector<uint16_t> &values) {
+    if (quantity == 0 || quantity > MAX_WRITE_REGISTERS || values.size() < quantity)
+        throw std::invalid_argument("Invalid register quantity for a Write Multiple Registers request.");
+    writeRequestHeader(pdu, FunctionCode::WriteMultipleRegisters, startAddress, quantity);
+    pdu[5] = static_cast<std::byte>(quantity * 2);
+    for (int i = 0; i < quantity; ++i)
+        std::tie(pdu[6 + i * 2], pdu[7 + i * 2]) = Utilities::uint16ToTwoBytes(values[i]);
+    return 6 + quantity * 2;
+}
+
+std::pair<Modbus::MBAP, std::span<const std::byte>>
+Modbus::ClientProtocol::splitResponseFrame(std::span<const std::byte> frame) {
+    if (frame.size() <= static_cast<std::size_t>(MBAP_HEADER_LENGTH))
+        throw std::runtime_error("Response frame without PDU.");
+    auto mbap = bytesToMBAP(frame);
+    if (mbap.protocolIdentifier != 0)
+        throw std::runtime_error("Response frame is not a Modbus/TCP frame.");
+    return {mbap, frame.subspan(MBAP_HEADER_LENGTH)};
+}
+
+void Modbus::ClientProtocol::checkResponse(std::span<const std::byte> request, std::span<const std::byte> response) {
+    auto functionCode = request[0];
+    if (response.size() == 2 && response[0] == (functionCode | std::byte{0x80}))
+        throw ExceptionResponseError(static_cast<FunctionCode>(functionCode), static_cast<ExceptionCode>(response[1]));
+    if (response.empty() || response[0] != functionCode)
+        throw std::runtime_error("Response does not match the request.");
+
+    switch (static_cast<FunctionCode>(functionCode)) {
+        case FunctionCode::ReadCoils:
+        case FunctionCode::ReadDiscreteInputs:
+        case FunctionCode::ReadHoldingRegisters:
+        case FunctionCode::ReadInputRegister: {
+            auto quantity = requestQuantity(request);
+            bool bits = functionCode == static_cast<std::byte>(FunctionCode::ReadCoils) ||
+                        functionCode == static_cast<std::byte>(FunctionCode::ReadDiscreteInputs);
+            auto byteCount = bits ? calculateBytesFromBits(quantity) : quantity * 2;
+            if (response.size() != static_cast<std::size_t>(2 + byteCount) ||
+                response[1] != static_cast<std::byte>(byteCount))
+                throw std::runtime_error("Response does not hold the quantity requested.");
+            break;
+        }
+        default:
+            // The write responses echo the address and the value or quantity of the request
+            if (response.size() != 5 || !std::equal(response.begin() + 1, response.end(), request.begin() + 1))
+                throw std::runtime_error("Write response does not echo the request.");
+    }
+}
+
+std::optional<std::span<const std::byte>> Modbus::ClientProtocol::nextResponseFrame(FrameAssembler &frames) {
+    try {
+        return frames.nextFrame();
+    } catch (std::invalid_argument &e) {
+        throw std::runtime_error("Malformed response frame.");
+    }
+}
+
+std::optional<std::span<const std::byte>>
+Modbus::ClientProtocol::nextResponse(FrameAssembler &frames, uint16_t transaction, uint8_t unitIdentifier,
+                                     std::span<const std::byte> request) {
+    while (auto frame = nextResponseFrame(frames)) {
+        auto [mbap, response] = splitResponseFrame(*frame);
+        if (mbap.transactionIdentifier != transaction)
+            continue; // A late response to a request that was given up on
+        if (mbap.unitIdentifier != unitIdentifier)
+            throw std::runtime_error("Response does not match the request.");
+        checkResponse(request, response);
+        return response;
+    }
+    return std::nullopt;
+}
+
+std::vector<bool> Modbus::ClientProtocol::decodeBits(std::span<const std::byte> response, uint16_t quantity) {
+    auto packed = response.subspan(2);
+    auto values = Utilities::bytesToBooleans(std::vector<std::byte>(packed.begin(), packed.end()));
+    values.resize(quantity);
+    return values;
+}
+
+std::vector<uint16_t> Modbus::ClientProtocol::decodeRegisters(std::span<const std::byte> response, uint16_t quantity) {
+    std::vector<uint16_t> values(quantity);
+    for (int i = 0; i < quantity; ++i)
+        values[i] = Utilities::twoBytesToUint16(response[2 + i * 2], response[3 + i * 2]);
+    return values;
+}
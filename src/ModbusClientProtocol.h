@@ -0,0 +1,135 @@
+#ifndef MBLIBRARY_MODBUSCLIENTPROTOCOL_H
+#define MBLIBRARY_MODBUSCLIENTPROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Modbus.h"
+#include "ModbusFrameAssembler.h"
+#include "ModbusPDU.h"
+
+namespace Modbus {
+
+    /**
+     * @class ExceptionResponseError
+     * @brief Thrown by the clients when the server answers a request with a Modbus exception response.
+     */
+    class ExceptionResponseError : public std::runtime_error {
+    public:
+        ExceptionResponseError(FunctionCode functionCode, ExceptionCode exceptionCode);
+
+        /**
+         * @brief Returns the function code of the request that was rejected.
+         */
+        FunctionCode functionCode() const;
+
+        /**
+         * @brief Returns the exception code sent by the server.
+         */
+        ExceptionCode exceptionCode() const;
+
+    private:
+        FunctionCode _functionCode;
+        ExceptionCode _exceptionCode;
+    };
+}
+
+/**
+ * @brief The client side of the protocol: encoding of request PDUs and validation and decoding of response PDUs.
+ *
+ * The functions work on caller-provided buffers and do no I/O, so the blocking Client and the coroutine
+ * AsyncClient share them.
+ */
+namespace Modbus::ClientProtocol {
+    constexpr uint16_t MAX_READ_BITS = 2000;
+    constexpr uint16_t MAX_READ_REGISTERS = 125;
+    constexpr uint16_t MAX_WRITE_BITS = 1968;
+    constexpr uint16_t MAX_WRITE_REGISTERS = 123;
+
+    /**
+     * @brief Writes a Read Coils, Read Discrete Inputs, Read Holding Registers or Read Input Registers request.
+     *
+     * All the request builders write into pdu, which must hold at least MAX_PDU_LENGTH bytes, and return the
+     * length of the request.
+     *
+     * @throws std::invalid_argument if the quantity does not fit in a single response, or the function code is not a
+     * read function.
+     */
+    std::size_t buildReadRequest(std::span<std::byte> pdu, FunctionCode functionCode, uint16_t startAddress,
+                                 uint16_t quantity);
+
+    std::size_t buildWriteSingleCoilRequest(std::span<std::byte> pdu, uint16_t address, bool value);
+
+    std::size_t buildWriteSingleRegisterRequest(std::span<std::byte> pdu, uint16_t address, uint16_t value);
+
+    /**
+     * @throws std::invalid_argument if quantity is 0, above MAX_WRITE_BITS, or above the number of values.
+     */
+    std::size_t buildWriteMultipleCoilsRequest(std::span<std::byte> pdu, uint16_t startAddress, uint16_t quantity,
+                                               const std::vector<bool> &values);
+
+    /**
+     * @throws std::invalid_argument if quantity is 0, above MAX_WRITE_REGISTERS, or above the number of values.
+     */
+    std::size_t buildWriteMultipleRegistersRequest(std::span<std::byte> pdu, uint16_t startAddress,
+                                                   uint16_t quantity, const std::vector<uint16_t> &values);
+
+    /**
+     * @brief Splits a response frame into its MBAP header and its PDU.
+     *
+     * @throws std::runtime_error if the frame is not a Modbus/TCP frame with a PDU.
+     */
+    std::pair<MBAP, std::span<const std::byte>> splitResponseFrame(std::span<const std::byte> frame);
+
+    /**
+     * @brief Checks that response is a valid answer to request.
+     *
+     * The response must carry the function code of the request, the byte count of the quantity read, or the echo
+     * of a write.
+     *
+     * @throws ExceptionResponseError if the response is an exception response.
+     * @throws std::runtime_error if the response does not answer the request.
+     */
+    void checkResponse(std::span<const std::byte> request, std::span<const std::byte> response);
+
+    /**
+     * @brief Takes the next complete frame received on a connection.
+     *
+     * @return The frame, valid until frames.prepare() is called, or std::nullopt if more bytes must be received.
+     * @throws std::runtime_error if the frame is malformed.
+     */
+    std::optional<std::span<const std::byte>> nextResponseFrame(FrameAssembler &frames);
+
+    /**
+     * @brief Takes the response to a transaction from the frames received on a connection.
+     *
+     * Responses to other transactions, such as late answers to requests that were given up on, are skipped.
+     *
+     * @param frames The frames received on the connection.
+     * @param transaction The transaction identifier of the request.
+     * @param unitIdentifier The unit identifier of the request.
+     * @param request The PDU of the request.
+     * @return The checked PDU of the response, valid until frames.prepare() is called, or std::nullopt if more
+     * bytes must be received.
+     * @throws ExceptionResponseError if the response is an exception response.
+     * @throws std::runtime_error if the response does not answer the request or a frame is malformed.
+     */
+    std::optional<std::span<const std::byte>> nextResponse(FrameAssembler &frames, uint16_t transaction,
+                                                           uint8_t unitIdentifier, std::span<const std::byte> request);
+
+    /**
+     * @brief Decodes the values of a checked Read Coils or Read Discrete Inputs response.
+     */
+    std::vector<bool> decodeBits(std::span<const std::byte> response, uint16_t quantity);
+
+    /**
+     * @brief Decodes the values of a checked Read Holding Registers or Read Input Registers response.
+     */
+    std::vector<uint16_t> decodeRegisters(std::span<const std::byte> response, uint16_t quantity);
+}
+
+#endif //MBLIBRARY_MODBUSCLIENTPROTOCOL_H
@@ -2,101 +2,353 @@
 #include "Modbus.h"
 #include <utility>
 
-Modbus::DataArea::DataArea() : _coils(), _discreteInputs(), _holdingRegisters(), _inputRegisters(), _mutex() {
+namespace {
+    /**
+     * @brief Copies the values and occupancy of a table; the caller holds every writer lock of source.
+     */
+    template<typename Table>
+    void copyStorage(Table &target, const Table &source) {
+        target.values = source.values;
+        target.occupied = source.occupied;
+    }
+}
+
+Modbus::DataAreaSnapshot::DataAreaSnapshot(std::shared_ptr<const DataTables> tables) : _tables(std::move(tables)) {
+}
+
+bool Modbus::DataAreaSnapshot::contains(TableType table, int address) const {
+    return isValidAddress(address) && _tables->visit(table, [address](const auto &data) {
+        return data.occupied.test(address);
+    });
+}
+
+uint16_t Modbus::DataAreaSnapshot::value(TableType table, int address) const {
+    if (!contains(table, address))
+        throw std::out_of_range("Register does not exist in the snapshot.");
+    return _tables->visit(table, [address](const auto &data) { return static_cast<uint16_t>(data.read(address)); });
+}
+
+std::size_t Modbus::DataAreaSnapshot::size(TableType table) const {
+    return _tables->visit(table, [](const auto &data) { return data.occupied.count(); });
+}
+
+Modbus::DataArea::DataArea() : DataArea(std::make_unique<MemoryDataStore>()) {
+}
+
+Modbus::DataArea::DataArea(std::unique_ptr<DataStore> store) : _store(std::move(store)), _tables(&_store->tables()) {
+}
+
+Modbus::DataArea::DataArea(const std::filesystem::path &file, MappedFileOptions options)
+        : DataArea(std::make_unique<MappedFileDataStore>(file, options)) {
 }
 
 void Modbus::DataArea::insertCoil(Modbus::Coil coil) {
-    if (_coils.size() == Modbus::MAX_REGISTER_DATA_AREA_SIZE)
+    if (!isValidAddress(coil.getAddress()))
         throw std::range_error("Maximum number of coils exceeded.");
-    insertRegister(_coils, std::move(coil));
+    insertRegister(_tables->coils, std::move(coil));
 }
 
 void Modbus::DataArea::insertDiscreteInput(Modbus::DiscreteInput input) {
-    if (_discreteInputs.size() == Modbus::MAX_REGISTER_DATA_AREA_SIZE)
+    if (!isValidAddress(input.getAddress()))
         throw std::range_error("Maximum number of discrete inputs exceeded.");
-    insertRegister(_discreteInputs, std::move(input));
+    insertRegister(_tables->discreteInputs, std::move(input));
 }
 
 void Modbus::DataArea::insertHoldingRegister(Modbus::HoldingRegister holdingRegister) {
-    if (_holdingRegisters.size() == Modbus::MAX_REGISTER_DATA_AREA_SIZE)
+    if (!isValidAddress(holdingRegister.getAddress()))
         throw std::range_error("Maximum number of holding registers exceeded.");
-    insertRegister(_holdingRegisters, std::move(holdingRegister));
+    insertRegister(_tables->holdingRegisters, std::move(holdingRegister));
 }
 
 void Modbus::DataArea::insertInputRegister(Modbus::InputRegister inputRegister) {
-    if (_inputRegisters.size() == Modbus::MAX_REGISTER_DATA_AREA_SIZE)
+    if (!isValidAddress(inputRegister.getAddress()))
         throw std::range_error("Maximum number of input registers exceeded.");
-    insertRegister(_inputRegisters, std::move(inputRegister));
+    insertRegister(_tables->inputRegisters, std::move(inputRegister));
 }
 
-std::vector<Modbus::Coil> &Modbus::DataArea::getAllCoils() {
-    return getAllRegisters(_coils);
+std::vector<Modbus::Coil> Modbus::DataArea::getAllCoils() {
+    return getAllRegisters<Coil>(_tables->coils);
 }
 
-std::vector<Modbus::DiscreteInput> &Modbus::DataArea::getAllDiscreteInputs() {
-    return getAllRegisters(_discreteInputs);
+std::vector<Modbus::DiscreteInput> Modbus::DataArea::getAllDiscreteInputs() {
+    return getAllRegisters<DiscreteInput>(_tables->discreteInputs);
 }
 
-std::vector<Modbus::HoldingRegister> &Modbus::DataArea::getAllHoldingRegisters() {
-    return getAllRegisters(_holdingRegisters);
+std::vector<Modbus::HoldingRegister> Modbus::DataArea::getAllHoldingRegisters() {
+    return getAllRegisters<HoldingRegister>(_tables->holdingRegisters);
 }
 
-std::vector<Modbus::InputRegister> &Modbus::DataArea::getAllInputRegisters() {
-    return getAllRegisters(_inputRegisters);
+std::vector<Modbus::InputRegister> Modbus::DataArea::getAllInputRegisters() {
+    return getAllRegisters<InputRegister>(_tables->inputRegisters);
 }
 
 std::vector<Modbus::Coil> Modbus::DataArea::getCoils(int start, int length) {
-    if (start < 0 || start + length > _coils.size() || length > Modbus::MAX_COILS || length < 0)
+    if (start < 0 || length > Modbus::MAX_COILS || length < 0)
         throw std::out_of_range("Invalid coil address and/or length.");
-    return getRegisters(_coils, start, length);
+    return getRegisters<Coil>(_tables->coils, start, length);
 }
 
 std::vector<Modbus::DiscreteInput> Modbus::DataArea::getDiscreteInputs(int start, int length) {
-    if (start < 0 || start + length > _discreteInputs.size() || length > Modbus::MAX_DISCRETE_INPUTS || length < 0)
+    if (start < 0 || length > Modbus::MAX_DISCRETE_INPUTS || length < 0)
         throw std::out_of_range("Invalid discrete input address and/or length.");
-    return getRegisters(_discreteInputs, start, length);
+    return getRegisters<DiscreteInput>(_tables->discreteInputs, start, length);
 }
 
 std::vector<Modbus::HoldingRegister> Modbus::DataArea::getHoldingRegisters(int start, int length) {
-    if (start < 0 || start + length > _holdingRegisters.size() || length > Modbus::MAX_HOLDING_REGISTERS || length < 0)
+    if (start < 0 || length > Modbus::MAX_HOLDING_REGISTERS || length < 0)
         throw std::out_of_range("Invalid holding register address and/or length.");
-    return getRegisters(_holdingRegisters, start, length);
+    return getRegisters<HoldingRegister>(_tables->holdingRegisters, start, length);
 }
 
 std::vector<Modbus::InputRegister> Modbus::DataArea::getInputRegisters(int start, int length) {
-    if (start < 0 || start + length > _inputRegisters.size() || length > Modbus::MAX_INPUT_REGISTERS || length < 0)
+    if (start < 0 || length > Modbus::MAX_INPUT_REGISTERS || length < 0)
         throw std::out_of_range("Invalid input register address and/or length.");
-    return getRegisters(_inputRegisters, start, length);
+    return getRegisters<InputRegister>(_tables->inputRegisters, start, length);
+}
+
+void Modbus::DataArea::readCoils(int start, int quantity, std::span<std::byte> packedValues) {
+    if (!tryReadCoils(start, quantity, packedValues))
+        throw std::out_of_range("Invalid coil address and/or length.");
+}
+
+void Modbus::DataArea::readDiscreteInputs(int start, int quantity, std::span<std::byte> packedValues) {
+    if (!tryReadDiscreteInputs(start, quantity, packedValues))
+        throw std::out_of_range("Invalid discrete input address and/or length.");
+}
+
+void Modbus::DataArea::readHoldingRegisters(int start, std::span<uint16_t> values) {
+    if (!tryReadHoldingRegisters(start, values))
+        throw std::out_of_range("Invalid holding register address and/or length.");
+}
+
+void Modbus::DataArea::readInputRegisters(int start, std::span<uint16_t> values) {
+    if (!tryReadInputRegisters(start, values))
+        throw std::out_of_range("Invalid input register address and/or length.");
+}
+
+Modbus::AccessResult Modbus::DataArea::tryReadCoils(int start, int quantity, std::span<std::byte> packedValues) {
+    if (quantity < 0 || quantity > Modbus::MAX_COILS)
+        return AccessError::InvalidQuantity;
+    if (!readPackedBits(_tables->coils, start, quantity, packedValues))
+        return AccessError::InvalidAddress;
+    return {};
+}
+
+Modbus::AccessResult
+Modbus::DataArea::tryReadDiscreteInputs(int start, int quantity, std::span<std::byte> packedValues) {
+    if (quantity < 0 || quantity > Modbus::MAX_DISCRETE_INPUTS)
+        return AccessError::InvalidQuantity;
+    if (!readPackedBits(_tables->discreteInputs, start, quantity, packedValues))
+        return AccessError::InvalidAddress;
+    return {};
+}
+
+Modbus::AccessResult Modbus::DataArea::tryReadHoldingRegisters(int start, std::span<uint16_t> values) {
+    auto length = static_cast<int>(values.size());
+    if (length > Modbus::MAX_HOLDING_REGISTERS)
+        return AccessError::InvalidQuantity;
+    if (!readRegisters(_tables->holdingRegisters, start, length, [values](int i, uint16_t value) {
+        values[i] = value;
+    }))
+        return AccessError::InvalidAddress;
+    return {};
+}
+
+Modbus::AccessResult Modbus::DataArea::tryReadInputRegisters(int start, std::span<uint16_t> values) {
+    auto length = static_cast<int>(values.size());
+    if (length > Modbus::MAX_INPUT_REGISTERS)
+        return AccessError::InvalidQuantity;
+    if (!readRegisters(_tables->inputRegisters, start, length, [values](int i, uint16_t value) {
+        values[i] = value;
+    }))
+        return AccessError::InvalidAddress;
+    return {};
 }
 
 void Modbus::DataArea::generateCoils(int startAddress, int count, Modbus::ValueGenerationType type) {
-    generateBooleanRegisters(_coils, startAddress, count, type);
+    generateBooleanRegisters<Coil>(_tables->coils, startAddress, count, type);
 }
 
 void Modbus::DataArea::generateDiscreteInputs(int startAddress, int count, Modbus::ValueGenerationType type) {
-    generateBooleanRegisters(_discreteInputs, startAddress, count, type);
+    generateBooleanRegisters<DiscreteInput>(_tables->discreteInputs, startAddress, count, type);
 }
 
 void Modbus::DataArea::generateHoldingRegisters(int startAddress, int count, Modbus::ValueGenerationType type) {
-    generateIntegerRegisters(_holdingRegisters, startAddress, count, type);
+    generateIntegerRegisters<HoldingRegister>(_tables->holdingRegisters, startAddress, count, type);
 }
 
 void Modbus::DataArea::generateInputRegisters(int startAddress, int count, Modbus::ValueGenerationType type) {
-    generateIntegerRegisters(_inputRegisters, startAddress, count, type);
+    generateIntegerRegisters<InputRegister>(_tables->inputRegisters, startAddress, count, type);
 }
 
 void Modbus::DataArea::writeSingletCoil(int address, bool value) {
-    auto coil = getRegister(_coils, address);
-    if (!coil)
+    if (!tryWriteSingleCoil(address, value))
         throw std::out_of_range("Invalid coil address.");
-    coil->write(value);
 }
 
 void Modbus::DataArea::writeSingleRegister(int address, int value) {
-    auto holdingRegister = getRegister(_holdingRegisters, address);
-    if (!holdingRegister)
+    if (!tryWriteSingleRegister(address, static_cast<uint16_t>(value)))
         throw std::out_of_range("Invalid holding register address.");
-    holdingRegister->write(value);
 }
 
+void Modbus::DataArea::writeCoils(int start, int quantity, std::span<const std::byte> packedValues) {
+    if (auto result = tryWriteCoils(start, quantity, packedValues); !result) {
+        if (result.error() == AccessError::InvalidAddress)
+            throw std::out_of_range("Invalid coil address and/or quantity.");
+        throw std::invalid_argument("Not enough packed values for the coil quantity.");
+    }
+}
 
+void Modbus::DataArea::writeHoldingRegisters(int start, std::span<const uint16_t> values) {
+    if (!tryWriteHoldingRegisters(start, values))
+        throw std::out_of_range("Invalid holding register address and/or quantity.");
+}
+
+void Modbus::DataArea::writeDiscreteInputs(int start, int quantity, std::span<const std::byte> packedValues) {
+    if (auto result = tryWriteDiscreteInputs(start, quantity, packedValues); !result) {
+        if (result.error() == AccessError::InvalidAddress)
+            throw std::out_of_range("Invalid discrete input address and/or quantity.");
+        throw std::invalid_argument("Not enough packed values for the discrete input quantity.");
+    }
+}
+
+void Modbus::DataArea::writeInputRegisters(int start, std::span<const uint16_t> values) {
+    if (!tryWriteInputRegisters(start, values))
+        throw std::out_of_range("Invalid input register address and/or quantity.");
+}
+
+Modbus::AccessResult Modbus::DataArea::tryWriteSingleCoil(int address, bool value) {
+    if (!writeRegister(_tables->coils, address, value))
+        return AccessError::InvalidAddress;
+    notify(TableType::Coils, address, 1);
+    return {};
+}
+
+Modbus::AccessResult Modbus::DataArea::tryWriteSingleRegister(int address, uint16_t value) {
+    if (!writeRegister(_tables->holdingRegisters, address, value))
+        return AccessError::InvalidAddress;
+    notify(TableType::HoldingRegisters, address, 1);
+    return {};
+}
+
+Modbus::AccessResult
+Modbus::DataArea::tryWriteCoils(int start, int quantity, std::span<const std::byte> packedValues) {
+    if (quantity < 0)
+        return AccessError::InvalidQuantity;
+    if (packedValues.size() < static_cast<std::size_t>(calculateBytesFromBits(quantity)))
+        return AccessError::BufferTooSmall;
+    if (!writePackedBits(_tables->coils, start, quantity, packedValues))
+        return AccessError::InvalidAddress;
+    notify(TableType::Coils, start, quantity);
+    return {};
+}
+
+Modbus::AccessResult Modbus::DataArea::tryWriteHoldingRegisters(int start, std::span<const uint16_t> values) {
+    if (!writeRegisters(_tables->holdingRegisters, start, static_cast<int>(values.size()),
+                        [values](int i) { return values[i]; }))
+        return AccessError::InvalidAddress;
+    notify(TableType::HoldingRegisters, start, static_cast<int>(values.size()));
+    return {};
+}
+
+Modbus::AccessResult
+Modbus::DataArea::tryWriteDiscreteInputs(int start, int quantity, std::span<const std::byte> packedValues) {
+    if (quantity < 0)
+        return AccessError::InvalidQuantity;
+    if (packedValues.size() < static_cast<std::size_t>(calculateBytesFromBits(quantity)))
+        return AccessError::BufferTooSmall;
+    if (!writePackedBits(_tables->discreteInputs, start, quantity, packedValues))
+        return AccessError::InvalidAddress;
+    notify(TableType::DiscreteInputs, start, quantity);
+    return {};
+}
+
+Modbus::AccessResult Modbus::DataArea::tryWriteInputRegisters(int start, std::span<const uint16_t> values) {
+    if (!writeRegisters(_tables->inputRegisters, start, static_cast<int>(values.size()),
+                        [values](int i) { return values[i]; }))
+        return AccessError::InvalidAddress;
+    notify(TableType::InputRegisters, start, static_cast<int>(values.size()));
+    return {};
+}
+
+Modbus::DataAreaSnapshot Modbus::DataArea::snapshot() {
+    auto copy = std::make_shared<DataTables>();
+    const auto &tables = *_tables;
+    // The writer locks are always taken in table order, and writers only ever lock the stripes of one table
+    tables.coils.stripes.exclusive(0, MAX_REGISTER_DATA_AREA_SIZE, [&]() {
+        tables.discreteInputs.stripes.exclusive(0, MAX_REGISTER_DATA_AREA_SIZE, [&]() {
+            tables.holdingRegisters.stripes.exclusive(0, MAX_REGISTER_DATA_AREA_SIZE, [&]() {
+                tables.inputRegisters.stripes.exclusive(0, MAX_REGISTER_DATA_AREA_SIZE, [&]() {
+                    copyStorage(copy->coils, tables.coils);
+                    copyStorage(copy->discreteInputs, tables.discreteInputs);
+                    copyStorage(copy->holdingRegisters, tables.holdingRegisters);
+                    copyStorage(copy->inputRegisters, tables.inputRegisters);
+                });
+            });
+        });
+    });
+    return DataAreaSnapshot(std::move(copy));
+}
+
+std::size_t Modbus::DataArea::subscribe(ChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(_subscribersMutex);
+    auto subscribers = _subscribers ? std::make_shared<std::vector<Subscriber>>(*_subscribers)
+                                    : std::make_shared<std::vector<Subscriber>>();
+    auto id = _nextSubscription++;
+    subscribers->push_back({id, std::move(callback)});
+    _subscribers = std::move(subscribers);
+    _hasSubscribers.store(true, std::memory_order_release);
+    return id;
+}
+
+void Modbus::DataArea::unsubscribe(std::size_t subscription) {
+    std::lock_guard<std::mutex> lock(_subscribersMutex);
+    if (!_subscribers)
+        throw std::invalid_argument("Unknown subscription.");
+    auto subscribers = std::make_shared<std::vector<Subscriber>>(*_subscribers);
+    auto removed = std::erase_if(*subscribers, [subscription](const Subscriber &subscriber) {
+        return subscriber.id == subscription;
+    });
+    if (removed == 0)
+        throw std::invalid_argument("Unknown subscription.");
+    if (subscribers->empty()) {
+        _subscribers.reset();
+        _hasSubscribers.store(false, std::memory_order_release);
+    } else {
+        _subscribers = std::move(subscribers);
+    }
+}
+
+void Modbus::DataArea::notify(TableType table, int start, int count) {
+    // Writers of a data area nobody subscribed to never touch the mutex
+    if (!_hasSubscribers.load(std::memory_order_acquire))
+        return;
+    std::shared_ptr<const std::vector<Subscriber>> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(_subscribersMutex);
+        subscribers = _subscribers;
+    }
+    if (!subscribers)
+        return;
+    DataChange change{table, start, count};
+    for (const auto &subscriber: *subscribers)
+        subscriber.callback(change);
+}
+
+Modbus::ChangeSet Modbus::DataArea::collectChanges(uint64_t sinceVersion) const {
+    // Any version counted here was taken inside a write section that collectTableChanges() waits for
+    ChangeSet changeSet{_tables->version.load(std::memory_order_acquire), {}};
+    collectTableChanges(_tables->coils, TableType::Coils, sinceVersion, changeSet.changes);
+    collectTableChanges(_tables->discreteInputs, TableType::DiscreteInputs, sinceVersion, changeSet.changes);
+    collectTableChanges(_tables->holdingRegisters, TableType::HoldingRegisters, sinceVersion, changeSet.changes);
+    collectTableChanges(_tables->inputRegisters, TableType::InputRegisters, sinceVersion, changeSet.changes);
+    return changeSet;
+}
+
+uint64_t Modbus::DataArea::version() const {
+    return _tables->version.load(std::memory_order_acquire);
+}
+
+void Modbus::DataArea::flush() {
+    _store->flush();
+}
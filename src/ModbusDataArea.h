@@ -2,7 +2,15 @@
 #include <vector>
 #include <mutex>
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
 #include "Modbus.h"
+#include "ModbusDataStore.h"
+#include "ModbusDataTable.h"
 #include "ModbusUtilities.h"
 
 #ifndef MODBUSDATAAREA_H
@@ -14,7 +22,6 @@ namespace Modbus {
     constexpr int MAX_HOLDING_REGISTERS = 123;
     constexpr int MAX_INPUT_REGISTERS = 123;
 
-    constexpr int MAX_REGISTER_DATA_AREA_SIZE = 1 << 16;
     /**
          * @enum ValueGenerationType
          * @brief Enumeration for different types of value generation.
@@ -36,26 +43,175 @@ namespace Modbus {
         Max // Maximum value for the data type
     };
 
+    /**
+     * @struct DataChange
+     * @brief Describes a write to a contiguous range of one table of a DataArea.
+     *
+     * One DataChange is published per write call, so a Modbus write request of many registers produces a single
+     * change covering all of them.
+     */
+    struct DataChange {
+        TableType table;
+        int start;
+        int count;
+
+        bool operator==(const DataChange &) const = default;
+    };
+
+    /**
+     * @struct ChangeSet
+     * @brief The ranges of a DataArea changed since a given version, as returned by DataArea::collectChanges().
+     */
+    struct ChangeSet {
+        /** The version to pass to the next call of collectChanges() to get only the changes made after this one. */
+        uint64_t version;
+        /** The changed ranges, ordered by table then address, merged when contiguous. */
+        std::vector<DataChange> changes;
+    };
+
+    /**
+     * @brief A callable notified of the changes made to a DataArea.
+     */
+    using ChangeCallback = std::function<void(const DataChange &)>;
+
+    /**
+     * @enum AccessError
+     * @brief Why a non-throwing access to a DataArea failed.
+     */
+    enum class AccessError : uint8_t {
+        InvalidAddress, ///< A point of the range does not exist.
+        InvalidQuantity, ///< The quantity is negative or larger than a single Modbus request may carry.
+        BufferTooSmall ///< The packed values hold fewer points than the quantity.
+    };
+
+    /**
+     * @class AccessResult
+     * @brief The outcome of a non-throwing access to a DataArea: success, or the AccessError that prevented it.
+     *
+     * It follows the interface of std::expected<void, AccessError>, which it stands in for until the library
+     * requires C++23.
+     *
+     * @par Example
+     * @code{.cpp}
+     * if (auto result = dataArea.tryReadHoldingRegisters(start, values); !result)
+     *     return buildExceptionResponse(functionCode, ExceptionCode::IllegalDataAddress, out);
+     * @endcode
+     */
+    class [[nodiscard]] AccessResult {
+    public:
+        constexpr AccessResult() = default;
+
+        constexpr AccessResult(AccessError error) : _error(error) {}
+
+        constexpr bool has_value() const {
+            return !_error.has_value();
+        }
+
+        constexpr explicit operator bool() const {
+            return has_value();
+        }
+
+        /**
+         * @brief Returns the reason of the failure; only meaningful when has_value() is false.
+         */
+        constexpr AccessError error() const {
+            return *_error;
+        }
+
+    private:
+        std::optional<AccessError> _error;
+    };
+
+    /**
+     * @class DataAreaSnapshot
+     * @brief An immutable copy of the four tables of a DataArea, taken at a single point in time.
+     *
+     * A snapshot owns its storage, so it stays valid whatever happens to the data area afterwards, and it can be
+     * read from any thread without synchronization. Copies of a snapshot share the same storage. Boolean values
+     * are reported as 0 or 1.
+     */
+    class DataAreaSnapshot {
+    public:
+        /**
+         * @brief Checks whether a register exists at address in the given table.
+         */
+        bool contains(TableType table, int address) const;
+
+        /**
+         * @brief Returns the value of the register at address in the given table.
+         *
+         * @throws std::out_of_range if the register does not exist.
+         */
+        uint16_t value(TableType table, int address) const;
+
+        /**
+         * @brief Returns the number of registers of the given table.
+         */
+        std::size_t size(TableType table) const;
+
+        /**
+         * @brief Calls fn(address, value) for every register of the given table, in ascending address order.
+         */
+        template<typename Function>
+        void forEach(TableType table, Function &&fn) const {
+            _tables->visit(table, [&](const auto &data) {
+                data.occupied.forEachSet([&](int address) { fn(address, static_cast<uint16_t>(data.read(address))); });
+            });
+        }
+
+    private:
+        friend class DataArea;
+
+        explicit DataAreaSnapshot(std::shared_ptr<const DataTables> tables);
+
+        std::shared_ptr<const DataTables> _tables;
+    };
+
     /**
      * @class DataArea
      * @brief Represents a data area for storing Modbus registers and coils.
      *
-     * The DataArea class provides a container for storing Modbus registers and coils. It ensures
-     * thread-safety by using a shared mutex to control access to the data. It also provides methods for
-     * inserting, retrieving, and modifying the registers and coils.
+     * The DataArea class provides a container for storing Modbus registers and coils. It is thread-safe, with
+     * the locking described below, and provides methods for inserting, retrieving, and modifying the registers
+     * and coils.
+     *
+     * Each table covers the whole 16-bit address space with dense storage: registers are kept in a flat
+     * array of uint16_t values and coils/discrete inputs in packed bitsets, with an occupancy bitmap recording
+     * which addresses exist. Reads and writes are plain index arithmetic on the address.
+     *
+     * Every table is synchronized on its own, in stripes of StripedSequenceLock::STRIPE_SIZE addresses. Writers
+     * lock only the stripes of the table they write, so writers of different tables, or of distant ranges of the
+     * same table, run in parallel. Readers never take a lock: a read is retried if it overlapped a write to the
+     * stripes it reads. Writes of several registers are therefore seen entirely or not at all, and a slow writer
+     * never blocks the pollers.
+     *
+     * The tables live in a DataStore: on the heap by default, or in a memory-mapped file that keeps them across
+     * restarts of the process.
      */
     class DataArea {
     public:
         /**
-         * @class DataArea
-         * @brief Represents a data area for storing Modbus registers and coils.
-         *
-         * The DataArea class provides a container for storing Modbus registers and coils. It ensures
-         * thread-safety by using a shared mutex to control access to the data. It also provides methods for
-         * inserting, retrieving, and modifying the registers and coils.
+         * @brief Creates an empty data area, with its tables on the heap.
          */
         DataArea();
 
+        /**
+         * @brief Creates a data area working on the tables of a store, with the registers the store already holds.
+         *
+         * @param store The store owning the tables; it must not be null.
+         */
+        explicit DataArea(std::unique_ptr<DataStore> store);
+
+        /**
+         * @brief Creates a data area persisted in a memory-mapped file, see MappedFileDataStore.
+         *
+         * The registers written by a previous run on the same file are available at once.
+         *
+         * @throws std::system_error if the file cannot be opened or is used by another data area.
+         * @throws std::invalid_argument if the file is not a table file of this library version.
+         */
+        explicit DataArea(const std::filesystem::path &file, MappedFileOptions options = {});
+
         /**
          * @brief Inserts a Coil into the container.
          *
@@ -181,11 +337,68 @@ namespace Modbus {
 
         void writeSingleRegister(int address, int value);
 
+        /**
+         * @brief Writes a contiguous range of coils from packed bits.
+         *
+         * The coil values are packed LSB first, eight per byte, as in a Write Multiple Coils request. The whole
+         * range is validated before anything is written and all values are committed under a single lock
+         * acquisition, so readers never observe a partially applied write.
+         *
+         * @param start The address of the first coil to write.
+         * @param quantity The number of coils to write.
+         * @param packedValues The packed coil values; must hold at least calculateBytesFromBits(quantity) bytes.
+         *
+         * @throw std::out_of_range if any coil of the range does not exist.
+         * @throw std::invalid_argument if packedValues is too small for quantity.
+         */
+        void writeCoils(int start, int quantity, std::span<const std::byte> packedValues);
+
+        /**
+         * @brief Writes a contiguous range of holding registers.
+         *
+         * The whole range is validated before anything is written and all values are committed under a single
+         * lock acquisition, so multi-register values such as 32-bit floats are seen consistently by readers.
+         *
+         * @param start The address of the first holding register to write.
+         * @param values The values to write, one per register.
+         *
+         * @throw std::out_of_range if any holding register of the range does not exist.
+         */
+        void writeHoldingRegisters(int start, std::span<const uint16_t> values);
+
+        /**
+         * @brief Writes a contiguous range of discrete inputs from packed bits.
+         *
+         * Discrete inputs are read-only for Modbus clients; this is how the application simulating the field side
+         * updates them. The semantics are those of writeCoils().
+         *
+         * @param start The address of the first discrete input to write.
+         * @param quantity The number of discrete inputs to write.
+         * @param packedValues The packed values, LSB first; must hold at least calculateBytesFromBits(quantity) bytes.
+         *
+         * @throw std::out_of_range if any discrete input of the range does not exist.
+         * @throw std::invalid_argument if packedValues is too small for quantity.
+         */
+        void writeDiscreteInputs(int start, int quantity, std::span<const std::byte> packedValues);
+
+        /**
+         * @brief Writes a contiguous range of input registers.
+         *
+         * Input registers are read-only for Modbus clients; this is how the application simulating the field side
+         * updates them. The semantics are those of writeHoldingRegisters().
+         *
+         * @param start The address of the first input register to write.
+         * @param values The values to write, one per register.
+         *
+         * @throw std::out_of_range if any input register of the range does not exist.
+         */
+        void writeInputRegisters(int start, std::span<const uint16_t> values);
+
         /**
          * @defgroup Coils Coils
          * @brief Functions related to retrieving all coils
          */
-        std::vector<Coil> &getAllCoils();
+        std::vector<Coil> getAllCoils();
 
         /**
          * @brief Retrieve the state of all the discrete inputs.
@@ -194,7 +407,7 @@ namespace Modbus {
          *
          * @return A vector of boolean values representing the state of all the discrete inputs.
          */
-        std::vector<DiscreteInput> &getAllDiscreteInputs();
+        std::vector<DiscreteInput> getAllDiscreteInputs();
 
         /**
          * @brief Retrieves all holding registers from a device.
@@ -204,7 +417,7 @@ namespace Modbus {
          *
          * @return An array containing all holding registers read from the device.
          */
-        std::vector<HoldingRegister> &getAllHoldingRegisters();
+        std::vector<HoldingRegister> getAllHoldingRegisters();
 
         /**
          * @brief Returns an array of all input registers.
@@ -213,7 +426,7 @@ namespace Modbus {
          *
          * @return An array of input registers.
          */
-        std::vector<InputRegister> &getAllInputRegisters();
+        std::vector<InputRegister> getAllInputRegisters();
 
         /**
          * @brief Retrieves a range of coil values from a specific start index.
@@ -270,195 +483,503 @@ namespace Modbus {
          */
         std::vector<InputRegister> getInputRegisters(int start, int length);
 
+        /**
+         * @brief Reads a range of coils into caller-provided packed bits.
+         *
+         * The coil values are packed LSB first, eight per byte, as in a Read Coils response. Nothing is
+         * allocated, which makes this the read path used by the PDU layer.
+         *
+         * @param start The address of the first coil to read.
+         * @param quantity The number of coils to read, at most MAX_COILS.
+         * @param packedValues The output bytes; must hold at least calculateBytesFromBits(quantity) bytes.
+         *
+         * @throw std::out_of_range if the quantity is invalid or any coil of the range does not exist.
+         * @throw std::invalid_argument if packedValues is too small for quantity.
+         */
+        void readCoils(int start, int quantity, std::span<std::byte> packedValues);
+
+        /**
+         * @brief Reads a range of discrete inputs into caller-provided packed bits.
+         *
+         * @see readCoils
+         */
+        void readDiscreteInputs(int start, int quantity, std::span<std::byte> packedValues);
+
+        /**
+         * @brief Reads a range of holding registers into a caller-provided buffer.
+         *
+         * Reads values.size() registers starting at start, without allocating.
+         *
+         * @param start The address of the first holding register to read.
+         * @param values The output buffer, one value per register; at most MAX_HOLDING_REGISTERS long.
+         *
+         * @throw std::out_of_range if the quantity is invalid or any register of the range does not exist.
+         */
+        void readHoldingRegisters(int start, std::span<uint16_t> values);
+
+        /**
+         * @brief Reads a range of input registers into a caller-provided buffer.
+         *
+         * @see readHoldingRegisters
+         */
+        void readInputRegisters(int start, std::span<uint16_t> values);
+
+        /**
+         * @name Non-throwing access
+         * The try functions behave like the functions of the same name without the prefix, but report failures in
+         * their result instead of throwing. They never allocate, so rejecting an invalid request costs no more than
+         * serving a valid one; the PDU handlers are built on them.
+         * @{
+         */
+        AccessResult tryReadCoils(int start, int quantity, std::span<std::byte> packedValues);
+
+        AccessResult tryReadDiscreteInputs(int start, int quantity, std::span<std::byte> packedValues);
+
+        AccessResult tryReadHoldingRegisters(int start, std::span<uint16_t> values);
+
+        AccessResult tryReadInputRegisters(int start, std::span<uint16_t> values);
+
+        AccessResult tryWriteSingleCoil(int address, bool value);
+
+        AccessResult tryWriteSingleRegister(int address, uint16_t value);
+
+        AccessResult tryWriteCoils(int start, int quantity, std::span<const std::byte> packedValues);
+
+        AccessResult tryWriteHoldingRegisters(int start, std::span<const uint16_t> values);
+
+        AccessResult tryWriteDiscreteInputs(int start, int quantity, std::span<const std::byte> packedValues);
+
+        AccessResult tryWriteInputRegisters(int start, std::span<const uint16_t> values);
+        /** @} */
+
+        /**
+         * @brief Takes a consistent copy of all four tables.
+         *
+         * The tables are copied in bulk while every writer lock of the data area is held, so the snapshot reflects
+         * a single point in time across tables. Writers wait for the copy; readers are not affected.
+         *
+         * @return The snapshot, which owns its storage.
+         */
+        DataAreaSnapshot snapshot();
+
+        /**
+         * @brief Calls fn(address, value) for every existing register of a range of a table, without copying.
+         *
+         * Addresses of the range without a register are skipped, so a whole sparse table can be visited with
+         * forEachRange(table, 0, MAX_REGISTER_DATA_AREA_SIZE, fn). Writers to the range wait until the visit ends,
+         * so all values come from a single point in time; fn should be short and must not write to the same table.
+         * Boolean values are reported as 0 or 1.
+         *
+         * @param table The table to visit.
+         * @param start The address of the first register of the range.
+         * @param length The number of addresses of the range.
+         * @param fn The callable receiving the address and value of each register, in ascending address order.
+         *
+         * @throws std::out_of_range if the range does not fit in the data area.
+         */
+        template<typename Function>
+        void forEachRange(TableType table, int start, int length, Function &&fn) {
+            if (!isValidRange(start, length))
+                throw std::out_of_range("Requested range does not exist");
+            _tables->visit(table, [&](const auto &data) {
+                data.stripes.exclusive(start, length, [&]() {
+                    data.occupied.forEachSetInRange(start, length, [&](int address) {
+                        fn(address, static_cast<uint16_t>(data.read(address)));
+                    });
+                });
+            });
+        }
+
+
+        /**
+         * @brief Registers a callback notified after every successful write to the data area.
+         *
+         * The callback is called synchronously on the writing thread, once per write call, after the new values are
+         * visible to readers and outside of any lock, so it may read the data area. It is not called for insertions
+         * and generation. It may be called concurrently from several writing threads, must not throw, and should be
+         * short since the writer, typically a server worker answering a request, waits for it.
+         *
+         * @param callback The callable receiving the changes.
+         * @return The identifier to pass to unsubscribe().
+         */
+        std::size_t subscribe(ChangeCallback callback);
+
+        /**
+         * @brief Removes a callback registered with subscribe().
+         *
+         * Writes that start after unsubscribe() returns no longer call the callback; a call already in progress on
+         * another thread may still complete.
+         *
+         * @param subscription The identifier returned by subscribe().
+         *
+         * @throw std::invalid_argument if no callback is registered with that identifier.
+         */
+        void unsubscribe(std::size_t subscription);
+
+        /**
+         * @brief Returns the ranges of every table written since a version of the data area.
+         *
+         * Every write, insertion and generation is recorded with a new version of the data area, at the granularity
+         * of blocks of BlockVersions::BLOCK_SIZE addresses, so a reported range may include unchanged or missing
+         * registers; forEachRange() visits such a range efficiently. Changes are collected without blocking writers.
+         *
+         * To mirror the data area, start with collectChanges(0), which reports every block ever written, then pass
+         * the version returned by each call to the next one. A write concurrent with a call is reported by that call,
+         * by the next one, or by both.
+         *
+         * @param sinceVersion The version returned by the previous call, or 0.
+         * @return The current version and the ranges written after sinceVersion.
+         */
+        ChangeSet collectChanges(uint64_t sinceVersion) const;
+
+        /**
+         * @brief Returns the current version of the data area, which grows with every write.
+         */
+        uint64_t version() const;
+
+        /**
+         * @brief Writes the tables to durable storage now, if the data area has any.
+         *
+         * @throws std::system_error if the write fails.
+         */
+        void flush();
 
     private:
+        struct Subscriber {
+            std::size_t id;
+            ChangeCallback callback;
+        };
 
-        std::vector<Coil> _coils;
-        std::vector<DiscreteInput> _discreteInputs;
-        std::vector<HoldingRegister> _holdingRegisters;
-        std::vector<InputRegister> _inputRegisters;
-        std::mutex _mutex;
-
-        /**
-      * @brief Inserts a register into the given vector of registers and sorts the vector based on the register's address.
-      *
-      * This function inserts a register of type T into the provided vector of registers. It also ensures thread-safety by
-      * acquiring a lock on the shared mutex before modifying the vector. If the size of the vector is greater than 1 after
-      * the insertion, the vector is sorted in ascending order based on the register's address.
-      *
-      * @tparam T The type of register to insert.
-      * @param registers The vector of registers to insert into.
-      * @param reg The register to insert.
-      *
-      * Example usage:
-      * ```cpp
-      * std::vector<std::shared_ptr<Register>> registers;
-      * auto register1 = std::make_shared<Register>(100);  // Suppose Register is a class and 100 is the address
-      * auto register2 = std::make_shared<Register>(50);
-      * insertRegister(registers, register1);
-      * insertRegister(registers, register2);
-      * ```
-      * After running this code, the 'registers' vector will contain pointers to 'register2' and 'register1' in that order.
-      */
-        template<typename T>
-        void insertRegister(std::vector<T> &registers, T reg) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (registerExists(registers, reg.getAddress()))
-                throw std::invalid_argument("Register with address " + reg.getAddressWithPrefix() + " already exists");
-            registers.push_back(reg);
-            if (registers.size() > 1)
-                std::ranges::sort(registers, [](const auto &a, const auto &b) {
-                    return a.getAddress() < b.getAddress();
+        std::unique_ptr<DataStore> _store;
+        DataTables *_tables;
+
+        // The subscriber list is never modified in place: subscribe() and unsubscribe() replace it under the mutex,
+        // and writers copy the pointer under the mutex only when the flag says there is someone to notify
+        std::shared_ptr<const std::vector<Subscriber>> _subscribers;
+        std::atomic<bool> _hasSubscribers{false};
+        std::mutex _subscribersMutex;
+        std::size_t _nextSubscription = 0;
+
+        /**
+         * @brief Calls every subscribed callback with the change of [start, start + count) of table.
+         */
+        void notify(TableType table, int start, int count);
+
+        /**
+         * @brief Records a write of [start, start + length) of a table with a new version of the data area.
+         *
+         * Must be called inside the write section of the range, which guarantees that collectChanges() sees the
+         * marks of every version it reports as collected.
+         */
+        template<typename Table>
+        void markChanged(Table &table, int start, int length) {
+            table.versions.mark(start, length, _tables->version.fetch_add(1, std::memory_order_relaxed) + 1);
+        }
+
+        /**
+         * @brief Appends the ranges of a table written after sinceVersion to changes, merging contiguous ones.
+         */
+        template<typename Table>
+        static void collectTableChanges(const Table &table, TableType type, uint64_t sinceVersion,
+                                        std::vector<DataChange> &changes) {
+            auto tableBegin = changes.size();
+            for (int stripe = 0; stripe < StripedSequenceLock::STRIPE_COUNT; ++stripe) {
+                auto stripeBegin = changes.size();
+                table.stripes.read(stripe * StripedSequenceLock::STRIPE_SIZE, StripedSequenceLock::STRIPE_SIZE, [&]() {
+                    changes.resize(stripeBegin);
+                    table.versions.forEachChangedRange(stripe, sinceVersion, [&](int start, int count) {
+                        changes.push_back({type, start, count});
+                    });
+                    return true;
                 });
+            }
+            // Runs are maximal within a stripe; join the ones that continue across stripe boundaries
+            auto kept = tableBegin;
+            for (auto i = tableBegin; i < changes.size(); ++i) {
+                if (kept > tableBegin && changes[kept - 1].start + changes[kept - 1].count == changes[i].start)
+                    changes[kept - 1].count += changes[i].count;
+                else
+                    changes[kept++] = changes[i];
+            }
+            changes.resize(kept);
         }
 
         /**
-         * @brief Retrieves all registers from the provided vector of registers.
+         * @brief Inserts a register into the given table.
          *
-         * This function returns a vector containing all registers from the provided vector of registers.
-         * It ensures thread-safety by acquiring a lock on the shared mutex before accessing the vector.
-         * The original vector is not modified.
+         * This function marks the register's address as existing in the table and stores its value. It ensures
+         * thread-safety by modifying the table inside a write section of the table's striped sequence lock. Since
+         * the table is indexed by address, the registers are always kept in ascending address order without any
+         * sorting.
          *
-         * @tparam T The type of registers in the vector.
-         * @param registers The vector of registers to retrieve.
-         * @return std::vector<std::shared_ptr<T>> The vector containing all registers.
+         * @tparam T The type of register to insert.
+         * @tparam Table The table type holding registers of type T (BooleanTable or IntegerTable).
+         * @param table The table to insert into.
+         * @param reg The register to insert.
+         *
+         * @throws std::invalid_argument if a register with the same address already exists.
          */
-        template<typename T>
-        std::vector<T> &getAllRegisters(std::vector<T> &registers) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            return registers;
+        template<typename T, typename Table>
+        void insertRegister(Table &table, T reg) {
+            auto inserted = table.stripes.write(reg.getAddress(), 1, [&]() {
+                if (registerExists(table, reg.getAddress()))
+                    return false;
+                table.occupied.set(reg.getAddress(), true);
+                table.write(reg.getAddress(), reg.read());
+                markChanged(table, reg.getAddress(), 1);
+                return true;
+            });
+            if (!inserted)
+                throw std::invalid_argument("Register with address " + reg.getAddressWithPrefix() + " already exists");
+        }
+
+        /**
+         * @brief Retrieves all registers from the provided table.
+         *
+         * This function returns a vector containing a copy of every existing register of the table, in ascending
+         * address order. The table is read without locking and the copy is rebuilt if a write overlapped it.
+         *
+         * @tparam T The type of registers to build.
+         * @param table The table to read from.
+         * @return std::vector<T> The vector containing all registers.
+         */
+        template<typename T, typename Table>
+        std::vector<T> getAllRegisters(const Table &table) {
+            return table.stripes.read(0, MAX_REGISTER_DATA_AREA_SIZE, [&]() {
+                std::vector<T> registers;
+                registers.reserve(table.occupied.count());
+                table.occupied.forEachSet([&](int address) {
+                    registers.emplace_back(address, table.read(address));
+                });
+                return registers;
+            });
         }
 
 
         /**
-         * @brief Retrieves a portion of registers from a vector.
+         * @brief Retrieves a range of registers from a table.
          *
-         * This function retrieves a specified range of registers from a given vector. It modifies the `registers`
-         * vector and fills it with the requested registers.
+         * The range is validated against the occupancy bitmap of the table a word at a time, and the values are
+         * then read by indexing the table directly with the address.
          *
-         * @tparam T The data type of the registers.
-         * @param registers The vector to retrieve the registers from.
-         * @param start The starting index of the registers to retrieve.
+         * @tparam T The type of registers to build.
+         * @param table The table to read from.
+         * @param start The starting address of the registers to retrieve.
          * @param length The number of registers to retrieve.
          *
-         * @note The function assumes that the `registers` vector has at least `start + length` elements to avoid
-         * any out-of-bounds access. If the `registers` vector has fewer elements, the behavior is undefined.
+         * @throws std::out_of_range if any address of the requested range does not exist.
          *
-         * @return void
+         * @return The registers of the range, in ascending address order.
          */
-        template<typename T>
-        std::vector<T> getRegisters(std::vector<T> &registers, int start, int length) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            // Calculate the end index of the range
-            int end = start + length - 1;
-            // Find the start and end iterators for the requested range
-            auto startIt = std::lower_bound(registers.begin(), registers.end(), start,
-                                            [](const T &reg, int start) {
-                                                return reg.getAddress() < start;
-                                            });
-            auto endIt = std::upper_bound(startIt, registers.end(), end,
-                                          [](int end, const T &reg) {
-                                              return end < reg.getAddress();
-                                          });
+        template<typename T, typename Table>
+        std::vector<T> getRegisters(const Table &table, int start, int length) {
+            if (!isValidRange(start, length))
+                throw std::out_of_range("Requested range does not exist");
+
+            std::vector<T> registers;
+            registers.reserve(length);
+            auto exists = table.stripes.read(start, length, [&]() {
+                registers.clear();
+                if (!table.occupied.allSet(start, length))
+                    return false;
+                table.readRange(start, length, [&](int i, typename Table::value_type value) {
+                    registers.emplace_back(start + i, value);
+                });
+                return true;
+            });
             // Throwing an exception if the requested range does not exist
-            if (startIt == registers.end() || endIt == registers.begin())
+            if (!exists)
                 throw std::out_of_range("Requested range does not exist");
+            return registers;
+        }
 
-            return {startIt, endIt};
+        /**
+         * @brief Reads a consistent range of existing registers of a table without locking.
+         *
+         * The range is read inside the table's striped sequence lock, so the consumer may be called again for the same
+         * indexes if a write overlapped the read; it must overwrite its output rather than accumulate into it.
+         *
+         * @tparam Table The table type (BooleanTable or IntegerTable).
+         * @tparam Consumer A callable taking the index in the range and the value of the register.
+         * @param table The table to read from.
+         * @param start The address of the first register to read.
+         * @param length The number of registers to read.
+         * @param consumer The callable receiving the values.
+         * @return true if the whole range exists and was read, false if the consumer was never called.
+         */
+        template<typename Table, typename Consumer>
+        bool readRegisters(const Table &table, int start, int length, Consumer &&consumer) {
+            if (!isValidRange(start, length))
+                return false;
+            return table.stripes.read(start, length, [&]() {
+                if (!table.occupied.allSet(start, length))
+                    return false;
+                table.readRange(start, length, consumer);
+                return true;
+            });
         }
 
         /**
-         * @brief This template function is used to retrieve a register from a vector of registers based on its address.
+         * @brief Reads a consistent range of boolean registers into packed bytes, LSB first, without locking.
+         */
+        bool readPackedBits(const BooleanTable &table, int start, int quantity, std::span<std::byte> packedValues) {
+            auto byteCount = static_cast<std::size_t>(calculateBytesFromBits(quantity));
+            if (packedValues.size() < byteCount)
+                throw std::invalid_argument("Output buffer too small for the requested quantity.");
+            if (!isValidRange(start, quantity))
+                return false;
+            return table.stripes.read(start, quantity, [&]() {
+                if (!table.occupied.allSet(start, quantity))
+                    return false;
+                table.values.readPacked(start, quantity, packedValues);
+                return true;
+            });
+        }
+
+        /**
+         * @brief Writes packed bytes, LSB first, to a range of existing boolean registers in one write section.
          *
-         * @tparam T The type of register (Coil, DiscreteInput, HoldingRegister, InputRegister).
-         * @param registers The vector of registers to search in.
-         * @param address The address of the register to retrieve.
-         * @return A pointer to the register if found, otherwise nullptr.
+         * @return true if the whole range exists and was written, false if nothing was written.
+         */
+        bool writePackedBits(BooleanTable &table, int start, int quantity, std::span<const std::byte> packedValues) {
+            if (!isValidRange(start, quantity))
+                return false;
+            return table.stripes.write(start, quantity, [&]() {
+                if (!table.occupied.allSet(start, quantity))
+                    return false;
+                table.values.writePacked(start, quantity, packedValues);
+                markChanged(table, start, quantity);
+                return true;
+            });
+        }
+
+        /**
+         * @brief Writes a value to an existing register of a table.
          *
-         * @details This function performs the following steps:
-         * 1. It uses a static assert to make sure that the provided register type is valid (either Coil, DiscreteInput,
-         *    HoldingRegister, or InputRegister).
-         * 2. It acquires a lock on the mutex object `_mutex` to ensure thread safety.
-         * 3. It searches for a register in the vector `registers` whose address matches the provided `address`.
-         * 4. If the register is found, a pointer to it is returned. Otherwise, nullptr is returned.
+         * @tparam Table The table type (BooleanTable or IntegerTable).
+         * @param table The table to write to.
+         * @param address The address of the register to write.
+         * @param value The value to write.
+         * @return true if the register exists and was written, false otherwise.
+         */
+        template<typename Table>
+        bool writeRegister(Table &table, int address, typename Table::value_type value) {
+            if (!isValidAddress(address))
+                return false;
+            return table.stripes.write(address, 1, [&]() {
+                if (!registerExists(table, address))
+                    return false;
+                table.write(address, value);
+                markChanged(table, address, 1);
+                return true;
+            });
+        }
+
+        /**
+         * @brief Writes a range of values to existing registers of a table in a single write section.
          *
-         * Example Usage:
-         * ```
-         * std::vector<HoldingRegister> registers;
-         * // Populate the registers vector...
-         *
-         * int address = 1234;
-         * HoldingRegister* registerPtr = getRegister(registers, address);
-         * if (registerPtr != nullptr) {
-         *     // Use the register...
-         * }
-         * ```
+         * Only the stripes of the range are locked, and readers see either all of the values or none.
          *
-         * @note The function assumes that the registers in the vector `registers` have a member function `getAddress()` that
-         *       returns their address.*/
-        template<typename T>
-        T *getRegister(std::vector<T> &registers, int address) {
-            static_assert(std::is_same<T, Coil>::value || std::is_same<T, DiscreteInput>::value ||
-                          std::is_same<T, HoldingRegister>::value || std::is_same<T, InputRegister>::value,
-                          "Invalid register type.");
-            std::lock_guard<std::mutex> lock(_mutex);
-            auto it = std::find_if(registers.begin(), registers.end(), [address](const T &reg) {
-                return reg.getAddress() == address;
+         * @tparam Table The table type (BooleanTable or IntegerTable).
+         * @tparam ValueAt A callable returning the value for the i-th register of the range.
+         * @param table The table to write to.
+         * @param start The address of the first register to write.
+         * @param length The number of registers to write.
+         * @param valueAt The callable providing the values.
+         * @return true if the whole range exists and was written, false if nothing was written.
+         */
+        template<typename Table, typename ValueAt>
+        bool writeRegisters(Table &table, int start, int length, ValueAt &&valueAt) {
+            if (!isValidRange(start, length))
+                return false;
+            return table.stripes.write(start, length, [&]() {
+                if (!table.occupied.allSet(start, length))
+                    return false;
+                table.writeRange(start, length, valueAt);
+                markChanged(table, start, length);
+                return true;
             });
-            if (it == registers.end())
-                return nullptr;
-            return &(*it);
         }
 
+        /**
+         * @brief Inserts a contiguous range of registers into a table in a single pass.
+         *
+         * The range is checked for existing registers a word of the occupancy bitmap at a time, then marked as
+         * occupied and filled with values, all in a single write section. Either every register of the range is
+         * inserted or none is.
+         *
+         * @tparam Table The table type (BooleanTable or IntegerTable).
+         * @tparam ValueAt A callable returning the value for the i-th register of the range.
+         * @param table The table to insert into.
+         * @param start The address of the first register to insert.
+         * @param count The number of registers to insert.
+         * @param valueAt The callable providing the values.
+         *
+         * @throws std::out_of_range if the range does not fit in the data area.
+         * @throws std::invalid_argument if a register of the range already exists.
+         */
+        template<typename Table, typename ValueAt>
+        void insertRegisters(Table &table, int start, int count, ValueAt &&valueAt) {
+            if (!isValidRange(start, count))
+                throw std::out_of_range("Generated registers exceed the data area.");
+            auto inserted = table.stripes.write(start, count, [&]() {
+                if (table.occupied.anySet(start, count))
+                    return false;
+                table.writeRange(start, count, valueAt);
+                table.occupied.setRange(start, count);
+                markChanged(table, start, count);
+                return true;
+            });
+            if (!inserted)
+                throw std::invalid_argument("Registers already exist in the requested range");
+        }
 
         /**
          * @brief Generates a series of boolean registers of type `Coil` or `DiscreteInput` based on the specified value generation type.
          *
          * @tparam T The type of register (Coil or DiscreteInput).
-         * @param registers The vector of registers to store the generated registers.
+         * @param table The table to store the generated registers.
          * @param startAddress The starting address for the generated registers.
          * @param count The number of registers to generate.
          * @param type The value generation type.
          *
+         * @throws std::out_of_range if the generated range does not fit in the data area.
+         * @throws std::invalid_argument if a register of the range already exists.
          * @throws std::invalid_argument if an invalid value generation type is provided.
          *
-         * This function generates boolean registers of the specified type (`Coil` or `DiscreteInput`) and inserts them into the provided vector `registers`.
+         * This function generates boolean registers of the specified type (`Coil` or `DiscreteInput`) and inserts them
+         * into the provided table with a single call to insertRegisters().
          * The generation of the registers depends on the specified value generation type. Supported value generation types are Zeros, Ones, and Random.
          *
-         * If the value generation type is Zeros, the function generates registers with a value of `false` and inserts them into the vector `registers`.
-         * If the value generation type is Ones, the function generates registers with a value of `true` and inserts them into the vector `registers`.
-         * If the value generation type is Random, the function generates registers with a random boolean value and inserts them into the vector `registers`.
+         * If the value generation type is Zeros, the function generates registers with a value of `false`.
+         * If the value generation type is Ones, the function generates registers with a value of `true`.
+         * If the value generation type is Random, the function generates registers with a random boolean value.
          *
-         * @note The function is thread-safe and uses a mutex to synchronize access to the vector `registers`.
+         * @note The function is thread-safe: the registers are inserted inside a write section of the table's
+         * striped sequence lock, so concurrent readers see each register either missing or with its value.
          *
          * Example usage:
          *
          * ```cpp
-         * std::vector<Coil> registers;
-         * generateBooleanRegisters(registers, 1000, 10, ValueGenerationType::Random);
+         * generateBooleanRegisters<Coil>(_tables->coils, 1000, 10, ValueGenerationType::Random);
          * ```
          */
         template<typename T>
-        void generateBooleanRegisters(std::vector<T> &registers, int startAddress, int count,
+        void generateBooleanRegisters(BooleanTable &table, int startAddress, int count,
                                       ValueGenerationType type) {
             static_assert(std::is_same<T, Coil>::value || std::is_same<T, DiscreteInput>::value,
                           "Invalid register type, register type must be Coil or DiscreteInput.");
             switch (type) {
                 case ValueGenerationType::Zeros:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, false));
-                    }
+                    insertRegisters(table, startAddress, count, [](int) { return false; });
                     break;
                 case ValueGenerationType::Ones:
                 case ValueGenerationType::Max:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, true));
-                    }
+                    insertRegisters(table, startAddress, count, [](int) { return true; });
                     break;
                 case ValueGenerationType::Random:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, Utilities::generateRandomBoolean()));
-                    }
+                    insertRegisters(table, startAddress, count,
+                                    [](int) { return Utilities::generateRandomBoolean(); });
                     break;
                 case ValueGenerationType::Decremental:
                 case ValueGenerationType::Incremental:
@@ -473,13 +994,13 @@ namespace Modbus {
          * \brief Generates integer registers based on the given parameters.
          *
          * \tparam T - The type of the registers.
-         * \param registers - The vector of registers to generate.
+         * \param table - The table to store the generated registers.
          * \param startAddress - The starting address of the registers.
          * \param count - The number of registers to generate.
          * \param type - The value generation type.
          *
          * This function generates integer registers based on the given parameters.
-         * The registers are inserted into the provided vector.
+         * The registers are inserted into the provided table with a single call to insertRegisters().
          *
          * Possible value generation types are:
          * - Zeros: generates registers with value 0.
@@ -487,46 +1008,41 @@ namespace Modbus {
          * - Random: generates registers with random integer values.
          * - Decremental: generates registers with values in decremental order (from count to 1).
          * - Incremental: generates registers with values in incremental order (from 0 to count-1).
+         * - Max: generates registers with the maximum 16-bit value.
          *
+         * \throws std::out_of_range if the generated range does not fit in the data area.
+         * \throws std::invalid_argument if a register of the range already exists.
          * \throws std::invalid_argument if an invalid value generation type is provided.
          * \throws std::invalid_argument if an invalid register type is provided (must be HoldingRegister or InputRegister).
          */
         template<typename T>
-        void generateIntegerRegisters(std::vector<T> &registers, int startAddress, int count,
+        void generateIntegerRegisters(IntegerTable &table, int startAddress, int count,
                                       ValueGenerationType type) {
             static_assert(std::is_same<T, HoldingRegister>::value || std::is_same<T, InputRegister>::value,
                           "Invalid register type, register type must be HoldingRegister or InputRegister.");
             switch (type) {
                 case ValueGenerationType::Zeros:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, 0));
-                    }
+                    insertRegisters(table, startAddress, count, [](int) { return uint16_t{0}; });
                     break;
                 case ValueGenerationType::Ones:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, 1));
-                    }
+                    insertRegisters(table, startAddress, count, [](int) { return uint16_t{1}; });
                     break;
                 case ValueGenerationType::Random:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, Utilities::generateRandomInteger()));
-                    }
+                    insertRegisters(table, startAddress, count, [](int) {
+                        return static_cast<uint16_t>(Utilities::generateRandomInteger());
+                    });
                     break;
                 case ValueGenerationType::Decremental:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, count - i));
-                    }
+                    insertRegisters(table, startAddress, count,
+                                    [count](int i) { return static_cast<uint16_t>(count - i); });
                     break;
                 case ValueGenerationType::Incremental:
-                    for (int i = 0; i < count; i++) {
-                        insertRegister(registers, T(startAddress + i, i));
-                    }
+                    insertRegisters(table, startAddress, count, [](int i) { return static_cast<uint16_t>(i); });
+                    break;
+                case ValueGenerationType::Max:
+                    insertRegisters(table, startAddress, count,
+                                    [](int) { return std::numeric_limits<uint16_t>::max(); });
                     break;
-                    // TODO: Implement tests for the Max value generation type
-                    case ValueGenerationType::Max:
-                        for (int i = 0; i < count; i++) {
-                            insertRegister(registers, T(startAddress + i, std::numeric_limits<int>::max()));
-                        }
                 default:
                     throw std::invalid_argument("Invalid value generation type.");
             }
@@ -534,26 +1050,22 @@ namespace Modbus {
         }
 
         /**
-         * @brief Checks if a register with the specified address already exists in the given vector of registers.
+         * @brief Checks if a register with the specified address exists in the given table.
          *
-         * @tparam T The type of register to check.
-         * @param registers The vector of registers to check.
+         * @tparam Table The table type to check.
+         * @param table The table to check.
          * @param address The address of the register to check.
-         * @return true if a register with the specified address exists in the vector, false otherwise.
+         * @return true if a register with the specified address exists in the table, false otherwise.
          * @par
          * Example usage:
          * ```cpp
-         * std::vector<Coil> coils;
-         * bool exists = registerExists(coils, 100);
+         * bool exists = registerExists(_tables->coils, 100);
          * ```
-         * In this example, the function will return true if a Coil object with address 100 exists in the 'coils' vector.
+         * In this example, the function will return true if a coil with address 100 exists in the data area.
          */
-        template<typename T>
-        bool registerExists(const std::vector<T> &registers, int address) {
-            auto it = std::find_if(registers.begin(), registers.end(), [address](const T &reg) {
-                return reg.getAddress() == address;
-            });
-            return it != registers.end();
+        template<typename Table>
+        static bool registerExists(const Table &table, int address) {
+            return isValidAddress(address) && table.occupied.test(address);
         }
     };
 }
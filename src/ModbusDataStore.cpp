@@ -0,0 +1,269 @@
+#include <atomic>
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ModbusDataStore.h"
+
+namespace {
+    constexpr std::size_t MAPPED_FILE_SIZE = Modbus::MappedFileHeader::TABLES_OFFSET + sizeof(Modbus::DataTables);
+
+    static_assert(sizeof(Modbus::MappedFileHeader) <= Modbus::MappedFileHeader::TABLES_OFFSET);
+    static_assert(Modbus::MappedFileHeader::TABLES_OFFSET % alignof(Modbus::DataTables) == 0);
+
+    std::system_error systemError(const std::string &what) {
+        return {errno, std::generic_category(), what};
+    }
+
+    /**
+     * @brief Checks that a mapped file holds tables laid out as this library lays them out.
+     */
+    void validateHeader(const std::byte *mapping, std::size_t size) {
+        const auto *header = reinterpret_cast<const Modbus::MappedFileHeader *>(mapping);
+        if (size < MAPPED_FILE_SIZE || header->magic != Modbus::MappedFileHeader::MAGIC)
+            throw std::invalid_argument("Not a Modbus data table file.");
+        if (header->formatVersion != Modbus::MappedFileHeader::FORMAT_VERSION ||
+            header->headerSize != sizeof(Modbus::MappedFileHeader) ||
+            header->tablesOffset != Modbus::MappedFileHeader::TABLES_OFFSET ||
+            header->tablesSize != sizeof(Modbus::DataTables))
+            throw std::invalid_argument("Modbus data table file written by an incompatible library version.");
+    }
+
+    /**
+     * @brief Writes the header of a new file or segment whose tables are set up.
+     *
+     * The format version is written last, with release semantics: a process attaching to a shared memory segment
+     * waits for it before reading the rest of the header or the tables.
+     */
+    void publishHeader(std::byte *mapping) {
+        auto *header = reinterpret_cast<Modbus::MappedFileHeader *>(mapping);
+        header->magic = Modbus::MappedFileHeader::MAGIC;
+        header->headerSize = sizeof(Modbus::MappedFileHeader);
+        header->tablesOffset = Modbus::MappedFileHeader::TABLES_OFFSET;
+        header->tablesSize = sizeof(Modbus::DataTables);
+        std::atomic_ref<uint32_t>(header->formatVersion).store(Modbus::MappedFileHeader::FORMAT_VERSION,
+                                                               std::memory_order_release);
+    }
+
+    bool headerPublished(std::byte *mapping) {
+        auto *header = reinterpret_cast<Modbus::MappedFileHeader *>(mapping);
+        return std::atomic_ref<uint32_t>(header->formatVersion).load(std::memory_order_acquire) != 0;
+    }
+
+    template<typename Tables>
+    Tables *tablesOf(std::byte *mapping) {
+        return std::launder(reinterpret_cast<Tables *>(mapping + Modbus::MappedFileHeader::TABLES_OFFSET));
+    }
+}
+
+Modbus::MemoryDataStore::MemoryDataStore() : _tables(std::make_unique<DataTables>()) {
+}
+
+Modbus::DataTables &Modbus::MemoryDataStore::tables() {
+    return *_tables;
+}
+
+Modbus::MappedFileDataStore::MappedFileDataStore(const std::filesystem::path &file, MappedFileOptions options)
+        : _options(options) {
+    try {
+        _file = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (_file < 0)
+            throw systemError("Cannot open " + file.string());
+        if (::flock(_file, LOCK_EX | LOCK_NB) != 0)
+            throw systemError("Cannot lock " + file.string());
+
+        struct stat status{};
+        if (::fstat(_file, &status) != 0)
+            throw systemError("Cannot stat " + file.string());
+        bool created = status.st_size == 0;
+        // A new file reads as zeros, which is a valid block of empty tables
+        if (created && ::ftruncate(_file, static_cast<off_t>(MAPPED_FILE_SIZE)) != 0)
+            throw systemError("Cannot size " + file.string());
+        _mappingSize = created ? MAPPED_FILE_SIZE : static_cast<std::size_t>(status.st_size);
+
+        auto *mapping = ::mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+        if (mapping == MAP_FAILED)
+            throw systemError("Cannot map " + file.string());
+        _mapping = static_cast<std::byte *>(mapping);
+
+        if (created)
+            publishHeader(_mapping);
+        validateHeader(_mapping, _mappingSize);
+        _tables = tablesOf<DataTables>(_mapping);
+        _tables->resetLocks();
+    } catch (...) {
+        close();
+        throw;
+    }
+
+    if (_options.syncInterval.count() > 0)
+        _syncThread = std::thread([this]() { syncPeriodically(); });
+}
+
+Modbus::MappedFileDataStore::~MappedFileDataStore() {
+    if (_syncThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_syncMutex);
+            _stopping = true;
+        }
+        _syncCondition.notify_one();
+        _syncThread.join();
+    }
+    ::msync(_mapping, _mappingSize, MS_SYNC);
+    close();
+}
+
+Modbus::DataTables &Modbus::MappedFileDataStore::tables() {
+    return *_tables;
+}
+
+void Modbus::MappedFileDataStore::flush() {
+    if (::msync(_mapping, _mappingSize, MS_SYNC) != 0)
+        throw systemError("Cannot flush the data table file");
+}
+
+void Modbus::MappedFileDataStore::syncPeriodically() {
+    std::unique_lock<std::mutex> lock(_syncMutex);
+    while (!_syncCondition.wait_for(lock, _options.syncInterval, [this]() { return _stopping; })) {
+        // Only the pages written since the last flush reach the disk; a failure is retried on the next interval
+        ::msync(_mapping, _mappingSize, MS_SYNC);
+    }
+}
+
+void Modbus::MappedFileDataStore::close() noexcept {
+    if (_mapping != nullptr)
+        ::munmap(_mapping, _mappingSize);
+    if (_file >= 0)
+        ::close(_file); // Also releases the lock
+    _mapping = nullptr;
+    _file = -1;
+}
+
+Modbus::SharedMemoryDataStore::SharedMemoryDataStore(std::string name, SharedMemoryMode mode,
+                                                     std::chrono::milliseconds attachTimeout)
+        : _name(std::move(name)) {
+    if (mode == SharedMemoryMode::Create)
+        create();
+    else
+        attach(attachTimeout);
+}
+
+Modbus::SharedMemoryDataStore::~SharedMemoryDataStore() {
+    ::munmap(_mapping, _mappingSize);
+    if (_created)
+        ::shm_unlink(_name.c_str());
+}
+
+Modbus::DataTables &Modbus::SharedMemoryDataStore::tables() {
+    return *_tables;
+}
+
+void Modbus::SharedMemoryDataStore::create() {
+    // A segment of the same name can only be left by a creator that did not shut down
+    ::shm_unlink(_name.c_str());
+    auto descriptor = ::shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    if (descriptor < 0)
+        throw systemError("Cannot create shared memory segment " + _name);
+    _mappingSize = MAPPED_FILE_SIZE;
+    void *mapping = MAP_FAILED;
+    if (::ftruncate(descriptor, static_cast<off_t>(_mappingSize)) == 0)
+        mapping = ::mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    auto error = mapping == MAP_FAILED ? errno : 0;
+    ::close(descriptor);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(_name.c_str());
+        throw std::system_error(error, std::generic_category(), "Cannot map shared memory segment " + _name);
+    }
+    _mapping = static_cast<std::byte *>(mapping);
+    _created = true;
+
+    // The new segment reads as zeros, which is a valid block of empty tables once its locks are set up
+    _tables = tablesOf<DataTables>(_mapping);
+    _tables->resetLocks();
+    publishHeader(_mapping);
+}
+
+void Modbus::SharedMemoryDataStore::attach(std::chrono::milliseconds timeout) {
+    auto descriptor = ::shm_open(_name.c_str(), O_RDWR, 0);
+    if (descriptor < 0)
+        throw systemError("Cannot open shared memory segment " + _name);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    // The creator sizes the segment first and publishes its header once the tables are set up
+    while (_mapping == nullptr || !headerPublished(_mapping)) {
+        struct stat status{};
+        if (::fstat(descriptor, &status) != 0) {
+            auto error = systemError("Cannot stat shared memory segment " + _name);
+            ::close(descriptor);
+            throw error;
+        }
+        if (_mapping == nullptr && static_cast<std::size_t>(status.st_size) >= MAPPED_FILE_SIZE) {
+            auto *mapping = ::mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            if (mapping == MAP_FAILED) {
+                auto error = systemError("Cannot map shared memory segment " + _name);
+                ::close(descriptor);
+                throw error;
+            }
+            _mapping = static_cast<std::byte *>(mapping);
+            _mappingSize = static_cast<std::size_t>(status.st_size);
+            continue;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            if (_mapping != nullptr)
+                ::munmap(_mapping, _mappingSize);
+            ::close(descriptor);
+            throw std::invalid_argument("Shared memory segment " + _name + " is not a Modbus data table segment.");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ::close(descriptor);
+
+    try {
+        validateHeader(_mapping, _mappingSize);
+    } catch (...) {
+        ::munmap(_mapping, _mappingSize);
+        throw;
+    }
+    _tables = tablesOf<DataTables>(_mapping);
+}
+
+Modbus::MappedFileView::MappedFileView(const std::filesystem::path &file) {
+    auto descriptor = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+        throw systemError("Cannot open " + file.string());
+    struct stat status{};
+    if (::fstat(descriptor, &status) != 0) {
+        auto error = systemError("Cannot stat " + file.string());
+        ::close(descriptor);
+        throw error;
+    }
+    _mappingSize = static_cast<std::size_t>(status.st_size);
+    auto *mapping = _mappingSize == 0 ? MAP_FAILED : ::mmap(nullptr, _mappingSize, PROT_READ, MAP_SHARED, descriptor, 0);
+    auto error = mapping == MAP_FAILED ? errno : 0;
+    ::close(descriptor); // The mapping stays valid without the descriptor
+    if (_mappingSize == 0)
+        throw std::invalid_argument("Not a Modbus data table file.");
+    if (mapping == MAP_FAILED)
+        throw std::system_error(error, std::generic_category(), "Cannot map " + file.string());
+    _mapping = static_cast<const std::byte *>(mapping);
+    try {
+        validateHeader(_mapping, _mappingSize);
+    } catch (...) {
+        ::munmap(const_cast<std::byte *>(_mapping), _mappingSize);
+        throw;
+    }
+}
+
+Modbus::MappedFileView::~MappedFileView() {
+    ::munmap(const_cast<std::byte *>(_mapping), _mappingSize);
+}
+
+const Modbus::DataTables &Modbus::MappedFileView::tables() const {
+    return *tablesOf<const DataTables>(const_cast<std::byte *>(_mapping));
+}
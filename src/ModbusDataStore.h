@@ -0,0 +1,223 @@
+#ifndef MBLIBRARY_MODBUSDATASTORE_H
+#define MBLIBRARY_MODBUSDATASTORE_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ModbusDataTable.h"
+
+namespace Modbus {
+
+    /**
+     * @class DataStore
+     * @brief Owns the memory holding the DataTables of a DataArea.
+     *
+     * The data area reads and writes the tables directly; the store only decides where they live and how they
+     * are persisted.
+     */
+    class DataStore {
+    public:
+        virtual ~DataStore() = default;
+
+        /**
+         * @brief Returns the tables; the reference stays valid for the lifetime of the store.
+         */
+        virtual DataTables &tables() = 0;
+
+        /**
+         * @brief Writes the tables to durable storage, if the store has any. Does nothing by default.
+         */
+        virtual void flush() {}
+    };
+
+    /**
+     * @class MemoryDataStore
+     * @brief Keeps the tables on the heap; they are lost when the store is destroyed.
+     */
+    class MemoryDataStore final : public DataStore {
+    public:
+        MemoryDataStore();
+
+        DataTables &tables() override;
+
+    private:
+        std::unique_ptr<DataTables> _tables;
+    };
+
+    /**
+     * @struct MappedFileHeader
+     * @brief The header at the start of the files of MappedFileDataStore and of the segments of
+     * SharedMemoryDataStore.
+     *
+     * The tables follow at tablesOffset, as one DataTables block of tablesSize bytes. A file whose magic, format
+     * version or table size differs from those of the library is rejected rather than misread.
+     */
+    struct MappedFileHeader {
+        static constexpr std::array<char, 8> MAGIC{'M', 'B', 'D', 'A', 'T', 'A', '\0', '\0'};
+        static constexpr uint32_t FORMAT_VERSION = 1;
+        static constexpr uint64_t TABLES_OFFSET = 4096;
+
+        std::array<char, 8> magic;
+        uint32_t formatVersion;
+        uint32_t headerSize;
+        uint64_t tablesOffset;
+        uint64_t tablesSize;
+    };
+
+    /**
+     * @struct MappedFileOptions
+     * @brief How a MappedFileDataStore persists its tables.
+     */
+    struct MappedFileOptions {
+        /// How often the tables are flushed to the file with msync. Zero leaves the write-back to the operating
+        /// system, which still happens within seconds of a write and when the store is destroyed.
+        std::chrono::milliseconds syncInterval{1000};
+    };
+
+    /**
+     * @class MappedFileDataStore
+     * @brief Keeps the tables in a memory-mapped file, so they survive restarts of the process.
+     *
+     * Opening a file written by a previous run restores its tables as they were, without copying or generating
+     * anything: the data area works on the mapped pages directly. A missing or empty file is created with empty
+     * tables. Writes are flushed to the file every MappedFileOptions::syncInterval by a background thread, on
+     * flush(), and when the store is destroyed.
+     *
+     * A file is used by a single store at a time, which holds an exclusive advisory lock on it. Other processes may
+     * still map the file read-only, for instance with MappedFileView, and read the tables without copying them.
+     */
+    class MappedFileDataStore final : public DataStore {
+    public:
+        /**
+         * @brief Opens or creates the file and maps its tables.
+         *
+         * @throws std::system_error if the file cannot be opened, locked, sized or mapped, in particular if another
+         * store already uses it.
+         * @throws std::invalid_argument if the file is not empty and is not a table file of this library version.
+         */
+        explicit MappedFileDataStore(const std::filesystem::path &file, MappedFileOptions options = {});
+
+        ~MappedFileDataStore() override;
+
+        MappedFileDataStore(const MappedFileDataStore &) = delete;
+        MappedFileDataStore &operator=(const MappedFileDataStore &) = delete;
+
+        DataTables &tables() override;
+
+        /**
+         * @brief Writes the tables to the file and waits for the write to complete.
+         *
+         * @throws std::system_error if the write fails.
+         */
+        void flush() override;
+
+    private:
+        int _file = -1;
+        std::byte *_mapping = nullptr;
+        std::size_t _mappingSize = 0;
+        DataTables *_tables = nullptr;
+        MappedFileOptions _options;
+
+        std::mutex _syncMutex;
+        std::condition_variable _syncCondition;
+        bool _stopping = false;
+        std::thread _syncThread;
+
+        void syncPeriodically();
+
+        void close() noexcept;
+    };
+
+    /**
+     * @enum SharedMemoryMode
+     * @brief Whether a SharedMemoryDataStore creates its segment or uses the segment of another process.
+     */
+    enum class SharedMemoryMode {
+        Create, ///< Create a new segment with empty tables, replacing any segment left with the same name.
+        Attach  ///< Use the segment created by another process.
+    };
+
+    /**
+     * @class SharedMemoryDataStore
+     * @brief Keeps the tables in a POSIX shared memory segment, so that co-located processes share one data area.
+     *
+     * One process, typically the one running the MBServer, creates the segment; the others attach to it. Every
+     * process then wraps its store in a DataArea and reads and writes the registers with plain memory accesses,
+     * synchronized across processes by the stripe locks and sequences stored in the segment. The stripe locks are
+     * robust: a process dying in the middle of a write does not block the others.
+     *
+     * collectChanges() sees the writes of every process, since the change versions live in the segment too.
+     * Subscribers are only notified of the writes made through their own DataArea.
+     *
+     * The creator removes the segment name when it is destroyed; processes still attached keep their mapping.
+     */
+    class SharedMemoryDataStore final : public DataStore {
+    public:
+        /**
+         * @brief Creates or attaches to the segment called name.
+         *
+         * @param name The POSIX name of the segment, such as "/plant".
+         * @param mode Whether to create the segment or attach to an existing one.
+         * @param attachTimeout How long an attaching process waits for a creator still setting the segment up.
+         * @throws std::system_error if the segment cannot be opened, created or mapped.
+         * @throws std::invalid_argument if the segment is not a table segment of this library version, or is still
+         * not set up after attachTimeout.
+         */
+        SharedMemoryDataStore(std::string name, SharedMemoryMode mode,
+                              std::chrono::milliseconds attachTimeout = std::chrono::milliseconds(1000));
+
+        ~SharedMemoryDataStore() override;
+
+        SharedMemoryDataStore(const SharedMemoryDataStore &) = delete;
+        SharedMemoryDataStore &operator=(const SharedMemoryDataStore &) = delete;
+
+        DataTables &tables() override;
+
+    private:
+        std::string _name;
+        bool _created = false;
+        std::byte *_mapping = nullptr;
+        std::size_t _mappingSize = 0;
+        DataTables *_tables = nullptr;
+
+        void create();
+
+        void attach(std::chrono::milliseconds timeout);
+    };
+
+    /**
+     * @class MappedFileView
+     * @brief A read-only mapping of the tables of a MappedFileDataStore file, for other processes.
+     *
+     * The tables are read in place. A consistent read of a range goes through the table's StripedSequenceLock,
+     * whose counters live in the file too, e.g. tables().holdingRegisters.stripes.read(start, length, fn).
+     */
+    class MappedFileView {
+    public:
+        /**
+         * @throws std::system_error if the file cannot be opened or mapped.
+         * @throws std::invalid_argument if the file is not a table file of this library version.
+         */
+        explicit MappedFileView(const std::filesystem::path &file);
+
+        ~MappedFileView();
+
+        MappedFileView(const MappedFileView &) = delete;
+        MappedFileView &operator=(const MappedFileView &) = delete;
+
+        const DataTables &tables() const;
+
+    private:
+        const std::byte *_mapping = nullptr;
+        std::size_t _mappingSize = 0;
+    };
+}
+
+#endif //MBLIBRARY_MODBUSDATASTORE_H
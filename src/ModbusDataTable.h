@@ -0,0 +1,696 @@
+#ifndef MBLIBRARY_MODBUSDATATABLE_H
+#define MBLIBRARY_MODBUSDATATABLE_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <pthread.h>
+
+namespace Modbus {
+    constexpr int MAX_REGISTER_DATA_AREA_SIZE = 1 << 16;
+
+    /**
+     * @brief Checks whether an address lies inside the 16-bit Modbus address space.
+     *
+     * @param address The address to check.
+     * @return true if the address is in the range [0, MAX_REGISTER_DATA_AREA_SIZE), false otherwise.
+     */
+    constexpr bool isValidAddress(int address) {
+        return address >= 0 && address < MAX_REGISTER_DATA_AREA_SIZE;
+    }
+
+    /**
+     * @brief Checks whether a range of addresses lies inside the 16-bit Modbus address space.
+     *
+     * @param start The first address of the range.
+     * @param length The number of addresses in the range.
+     * @return true if every address of the range is valid, false otherwise.
+     */
+    constexpr bool isValidRange(int start, int length) {
+        return start >= 0 && length >= 0 && start + length <= MAX_REGISTER_DATA_AREA_SIZE;
+    }
+
+    /**
+     * @brief Loads a value of table storage that writers may be updating concurrently.
+     *
+     * Table storage is read by lock-free readers while a writer updates it, so every access goes through a relaxed
+     * std::atomic_ref. On common targets this compiles to a plain load; a StripedSequenceLock decides whether the
+     * values read are consistent.
+     */
+    template<typename T>
+    T loadRelaxed(const T &value) {
+        return std::atomic_ref<T>(const_cast<T &>(value)).load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Stores a value of table storage that lock-free readers may be reading concurrently.
+     *
+     * @see loadRelaxed
+     */
+    template<typename T>
+    void storeRelaxed(T &target, T value) {
+        std::atomic_ref<T>(target).store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @class ProcessSharedMutex
+     * @brief A mutex that may be placed in memory shared between processes and survives the death of its owner.
+     *
+     * The tables may live in a shared memory segment written by several processes, where a std::mutex is not
+     * usable. This is a robust, process-shared pthread mutex: when its owner dies while holding it, the next lock()
+     * succeeds and reports it, so the caller can repair whatever the owner left half-done.
+     */
+    class ProcessSharedMutex {
+    public:
+        ProcessSharedMutex() {
+            pthread_mutexattr_t attributes;
+            pthread_mutexattr_init(&attributes);
+            pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+            auto result = pthread_mutex_init(&_mutex, &attributes);
+            pthread_mutexattr_destroy(&attributes);
+            if (result != 0)
+                throw std::system_error(result, std::generic_category(), "Cannot create a process-shared mutex");
+        }
+
+        ~ProcessSharedMutex() {
+            pthread_mutex_destroy(&_mutex);
+        }
+
+        ProcessSharedMutex(const ProcessSharedMutex &) = delete;
+        ProcessSharedMutex &operator=(const ProcessSharedMutex &) = delete;
+
+        /**
+         * @brief Locks the mutex.
+         *
+         * @return true if the previous owner died while holding the mutex, false otherwise.
+         * @throws std::system_error if the mutex cannot be locked.
+         */
+        bool lock() {
+            auto result = pthread_mutex_lock(&_mutex);
+            if (result == EOWNERDEAD) {
+                pthread_mutex_consistent(&_mutex);
+                return true;
+            }
+            if (result != 0)
+                throw std::system_error(result, std::generic_category(), "Cannot lock a process-shared mutex");
+            return false;
+        }
+
+        void unlock() {
+            pthread_mutex_unlock(&_mutex);
+        }
+
+    private:
+        pthread_mutex_t _mutex;
+    };
+
+    /**
+     * @class StripedSequenceLock
+     * @brief Per-stripe writer locks and sequence counters over the address space of a table.
+     *
+     * The table is split into stripes of STRIPE_SIZE addresses. A writer locks the mutexes of the stripes its range
+     * covers, in ascending order, and makes their sequences odd for the duration of the write, so writers of
+     * disjoint stripes run in parallel. Readers never take a lock: a reader notes the sequences of the stripes it
+     * reads, reads, and retries if any of them was odd or has changed since. A multi-register write is therefore
+     * either seen entirely or not at all.
+     *
+     * Locks and sequences work across processes when the table lives in shared memory. If a writer dies in the
+     * middle of a write, the next writer of the stripe makes its sequence even again, so readers do not wait
+     * forever; the range the dead writer was writing may then hold a mix of old and new values.
+     */
+    class StripedSequenceLock {
+    public:
+        static constexpr int STRIPE_SIZE = 4096;
+        static constexpr int STRIPE_COUNT = MAX_REGISTER_DATA_AREA_SIZE / STRIPE_SIZE;
+        static_assert(STRIPE_SIZE % 64 == 0, "A stripe must not share bitmap words with its neighbours");
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "Sequences must work in shared memory");
+
+        /**
+         * @brief Runs fn as a write section over [start, start + length) and returns its result.
+         *
+         * The range must be valid. fn may only modify table storage inside the range; a stripe is a multiple of
+         * 64 addresses, so it never shares a bitmap word with another stripe.
+         */
+        template<typename Function>
+        auto write(int start, int length, Function &&fn) {
+            WriteSection section(*this, start, length);
+            return fn();
+        }
+
+        /**
+         * @brief Runs fn while holding the writer locks of [start, start + length) and returns its result.
+         *
+         * No writer can modify the range while fn runs, so fn may read the table storage directly, for instance
+         * to copy it. Lock-free readers are not affected. fn must not write to the table, which would deadlock.
+         */
+        template<typename Function>
+        auto exclusive(int start, int length, Function &&fn) const {
+            StripeGuard guard(*this, start, length);
+            return fn();
+        }
+
+        /**
+         * @brief Runs fn until it completes without a concurrent write to [start, start + length) and returns its
+         * result.
+         *
+         * The range must be valid. fn may run several times and may see inconsistent values on the runs that are
+         * retried, so it must only read table storage and restart any output it produces.
+         */
+        template<typename Function>
+        auto read(int start, int length, Function &&fn) const {
+            auto [first, last] = stripesOf(start, length);
+            std::array<uint64_t, STRIPE_COUNT> sequences{};
+            for (;;) {
+                bool writing = false;
+                for (int stripe = first; stripe < last; ++stripe) {
+                    sequences[stripe] = _stripes[stripe].sequence.load(std::memory_order_acquire);
+                    writing = writing || (sequences[stripe] & 1U);
+                }
+                if (writing) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                auto result = fn();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                bool changed = false;
+                for (int stripe = first; stripe < last; ++stripe) {
+                    auto sequence = _stripes[stripe].sequence.load(std::memory_order_relaxed);
+                    changed = changed || sequence != sequences[stripe];
+                }
+                if (!changed)
+                    return result;
+            }
+        }
+
+    private:
+        struct alignas(64) Stripe {
+            mutable ProcessSharedMutex writer;
+            // Mutable so that exclusive(), which is const, can repair the sequence left odd by a dead writer
+            mutable std::atomic<uint64_t> sequence{0};
+
+            void lock() const {
+                if (writer.lock()) {
+                    auto current = sequence.load(std::memory_order_relaxed);
+                    if (current & 1U)
+                        sequence.store(current + 1, std::memory_order_release);
+                }
+            }
+        };
+
+        std::array<Stripe, STRIPE_COUNT> _stripes;
+
+        /**
+         * @brief Returns the half-open range of stripes covering [start, start + length).
+         */
+        static std::pair<int, int> stripesOf(int start, int length) {
+            if (length <= 0)
+                return {0, 0};
+            return {start / STRIPE_SIZE, (start + length - 1) / STRIPE_SIZE + 1};
+        }
+
+        /**
+         * @brief Holds the writer locks of the stripes covering a range, taken in ascending order.
+         */
+        class StripeGuard {
+        public:
+            StripeGuard(const StripedSequenceLock &lock, int start, int length) : _lock(lock) {
+                std::tie(first, last) = stripesOf(start, length);
+                for (int stripe = first; stripe < last; ++stripe)
+                    _lock._stripes[stripe].lock();
+            }
+
+            ~StripeGuard() {
+                for (int stripe = last - 1; stripe >= first; --stripe)
+                    _lock._stripes[stripe].writer.unlock();
+            }
+
+            StripeGuard(const StripeGuard &) = delete;
+            StripeGuard &operator=(const StripeGuard &) = delete;
+
+            int first = 0;
+            int last = 0;
+
+        private:
+            const StripedSequenceLock &_lock;
+        };
+
+        /**
+         * @brief Holds the writer locks of a range and keeps the sequences of its stripes odd.
+         */
+        class WriteSection {
+        public:
+            WriteSection(StripedSequenceLock &lock, int start, int length) : _lock(lock), _guard(lock, start, length) {
+                for (int stripe = _guard.first; stripe < _guard.last; ++stripe) {
+                    auto &sequence = _lock._stripes[stripe].sequence;
+                    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_release);
+            }
+
+            ~WriteSection() {
+                for (int stripe = _guard.first; stripe < _guard.last; ++stripe) {
+                    auto &sequence = _lock._stripes[stripe].sequence;
+                    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                }
+            }
+
+            WriteSection(const WriteSection &) = delete;
+            WriteSection &operator=(const WriteSection &) = delete;
+
+        private:
+            StripedSequenceLock &_lock;
+            StripeGuard _guard;
+        };
+    };
+
+    /**
+     * @class AddressBitmap
+     * @brief A packed bitset with one bit per Modbus address.
+     *
+     * The bitmap covers the whole 16-bit address space in 8 KiB. It is used both to store the values of
+     * boolean tables and to record which addresses of a table exist. Range queries work a 64-bit word at a time.
+     *
+     * Words are accessed with loadRelaxed() and storeRelaxed() so the bitmap can be read while a writer updates it.
+     * Updates are not atomic read-modify-writes: concurrent writers must be serialized by the caller.
+     */
+    class AddressBitmap {
+    public:
+        static constexpr int WORD_BITS = 64;
+        static constexpr int WORD_COUNT = MAX_REGISTER_DATA_AREA_SIZE / WORD_BITS;
+
+        bool test(int address) const {
+            return (loadRelaxed(_words[address / WORD_BITS]) >> (address % WORD_BITS)) & 1U;
+        }
+
+        void set(int address, bool value) {
+            auto mask = uint64_t{1} << (address % WORD_BITS);
+            auto &word = _words[address / WORD_BITS];
+            auto current = loadRelaxed(word);
+            storeRelaxed(word, value ? (current | mask) : (current & ~mask));
+        }
+
+        /**
+         * @brief Checks that every bit in [start, start + length) is set.
+         *
+         * An empty range is considered fully set.
+         */
+        bool allSet(int start, int length) const {
+            bool result = true;
+            forEachWordMask(start, length, [&](int word, uint64_t mask) {
+                result = result && (loadRelaxed(_words[word]) & mask) == mask;
+            });
+            return result;
+        }
+
+        /**
+         * @brief Checks whether any bit in [start, start + length) is set.
+         */
+        bool anySet(int start, int length) const {
+            bool result = false;
+            forEachWordMask(start, length, [&](int word, uint64_t mask) {
+                result = result || (loadRelaxed(_words[word]) & mask) != 0;
+            });
+            return result;
+        }
+
+        /**
+         * @brief Sets every bit in [start, start + length).
+         */
+        void setRange(int start, int length) {
+            forEachWordMask(start, length, [&](int word, uint64_t mask) {
+                storeRelaxed(_words[word], loadRelaxed(_words[word]) | mask);
+            });
+        }
+
+        /**
+         * @brief Returns the number of set bits.
+         */
+        std::size_t count() const {
+            std::size_t total = 0;
+            for (const auto &word: _words)
+                total += std::popcount(loadRelaxed(word));
+            return total;
+        }
+
+        /**
+         * @brief Calls consumer(i, bit) for the i-th bit of [start, start + length), loading a word at a time.
+         */
+        template<typename Consumer>
+        void readRange(int start, int length, Consumer &&consumer) const {
+            int i = 0;
+            forEachWordMask(start, length, [&](int word, uint64_t mask) {
+                auto bits = loadRelaxed(_words[word]);
+                int offset = std::countr_zero(mask);
+                for (int bit = offset; bit < offset + std::popcount(mask); ++bit)
+                    consumer(i++, ((bits >> bit) & 1U) != 0);
+            });
+        }
+
+        /**
+         * @brief Sets the i-th bit of [start, start + length) to valueAt(i), storing a word at a time.
+         */
+        template<typename ValueAt>
+        void writeRange(int start, int length, ValueAt &&valueAt) {
+            int i = 0;
+            forEachWordMask(start, length, [&](int word, uint64_t mask) {
+                uint64_t bits = 0;
+                int offset = std::countr_zero(mask);
+                for (int bit = offset; bit < offset + std::popcount(mask); ++bit) {
+                    if (valueAt(i++))
+                        bits |= uint64_t{1} << bit;
+                }
+                storeRelaxed(_words[word], (loadRelaxed(_words[word]) & ~mask) | bits);
+            });
+        }
+
+        /**
+         * @brief Copies the bits of [start, start + length) into bytes packed LSB first, eight bits per byte.
+         *
+         * This is the layout of the Modbus coil and discrete input responses, so the copy moves whole words
+         * instead of single bits. Bits past length in the last byte are cleared.
+         *
+         * @param packed The output bytes; must hold at least (length + 7) / 8 bytes.
+         */
+        void readPacked(int start, int length, std::span<std::byte> packed) const {
+            for (int i = 0; i < length; i += WORD_BITS) {
+                int count = std::min(WORD_BITS, length - i);
+                auto bits = extract(start + i, count);
+                for (int byte = 0; byte * 8 < count; ++byte)
+                    packed[i / 8 + byte] = static_cast<std::byte>(bits >> (byte * 8));
+            }
+        }
+
+        /**
+         * @brief Sets the bits of [start, start + length) from bytes packed LSB first, eight bits per byte.
+         *
+         * @param packed The input bytes; must hold at least (length + 7) / 8 bytes.
+         */
+        void writePacked(int start, int length, std::span<const std::byte> packed) {
+            for (int i = 0; i < length; i += WORD_BITS) {
+                int count = std::min(WORD_BITS, length - i);
+                uint64_t bits = 0;
+                for (int byte = 0; byte * 8 < count; ++byte)
+                    bits |= uint64_t{std::to_integer<uint8_t>(packed[i / 8 + byte])} << (byte * 8);
+                deposit(start + i, count, bits);
+            }
+        }
+
+        /**
+         * @brief Calls fn(address) for every set bit of [start, start + length), in ascending address order.
+         */
+        template<typename Function>
+        void forEachSetInRange(int start, int length, Function &&fn) const {
+            forEachWordMask(start, length, [&](int word, uint64_t mask) {
+                for (auto bits = loadRelaxed(_words[word]) & mask; bits != 0; bits &= bits - 1)
+                    fn(word * WORD_BITS + std::countr_zero(bits));
+            });
+        }
+
+        /**
+         * @brief Calls fn(address) for every set bit, in ascending address order.
+         */
+        template<typename Function>
+        void forEachSet(Function &&fn) const {
+            for (int word = 0; word < WORD_COUNT; ++word) {
+                for (auto bits = loadRelaxed(_words[word]); bits != 0; bits &= bits - 1)
+                    fn(word * WORD_BITS + std::countr_zero(bits));
+            }
+        }
+
+    private:
+        std::array<uint64_t, WORD_COUNT> _words{};
+
+        static constexpr uint64_t lowMask(int bits) {
+            return bits == WORD_BITS ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+        }
+
+        /**
+         * @brief Returns the count bits starting at address, which may straddle two words, in the low bits.
+         */
+        uint64_t extract(int address, int count) const {
+            int word = address / WORD_BITS;
+            int offset = address % WORD_BITS;
+            auto bits = loadRelaxed(_words[word]) >> offset;
+            if (offset + count > WORD_BITS)
+                bits |= loadRelaxed(_words[word + 1]) << (WORD_BITS - offset);
+            return bits & lowMask(count);
+        }
+
+        /**
+         * @brief Replaces the count bits starting at address, which may straddle two words, with the low bits of bits.
+         */
+        void deposit(int address, int count, uint64_t bits) {
+            int word = address / WORD_BITS;
+            int offset = address % WORD_BITS;
+            auto mask = lowMask(count);
+            bits &= mask;
+            storeRelaxed(_words[word], (loadRelaxed(_words[word]) & ~(mask << offset)) | (bits << offset));
+            if (offset + count > WORD_BITS) {
+                auto highMask = lowMask(offset + count - WORD_BITS);
+                storeRelaxed(_words[word + 1],
+                             (loadRelaxed(_words[word + 1]) & ~highMask) | (bits >> (WORD_BITS - offset)));
+            }
+        }
+
+        /**
+         * @brief Splits [start, start + length) into per-word masks and calls fn(wordIndex, mask) for each of them.
+         */
+        template<typename Function>
+        static void forEachWordMask(int start, int length, Function &&fn) {
+            int end = start + length;
+            while (start < end) {
+                int offset = start % WORD_BITS;
+                int bits = std::min(WORD_BITS - offset, end - start);
+                uint64_t mask = (bits == WORD_BITS ? ~uint64_t{0} : ((uint64_t{1} << bits) - 1)) << offset;
+                fn(start / WORD_BITS, mask);
+                start += bits;
+            }
+        }
+    };
+
+    /**
+     * @class BlockVersions
+     * @brief Records, for every block of BLOCK_SIZE addresses of a table, the version of the last write to it.
+     *
+     * Versions are also summarized per stripe of the table's StripedSequenceLock, so stripes left untouched since a
+     * given version are skipped without looking at their blocks. Writers mark the blocks they change inside their
+     * write section; readers scan a stripe inside a read of that stripe.
+     */
+    class BlockVersions {
+    public:
+        static constexpr int BLOCK_SIZE = 64;
+        static constexpr int BLOCK_COUNT = MAX_REGISTER_DATA_AREA_SIZE / BLOCK_SIZE;
+        static constexpr int BLOCKS_PER_STRIPE = StripedSequenceLock::STRIPE_SIZE / BLOCK_SIZE;
+
+        /**
+         * @brief Records version as the last write of every block overlapping [start, start + length).
+         */
+        void mark(int start, int length, uint64_t version) {
+            if (length <= 0)
+                return;
+            for (int block = start / BLOCK_SIZE; block <= (start + length - 1) / BLOCK_SIZE; ++block)
+                storeRelaxed(_blocks[block], version);
+            for (int stripe = start / StripedSequenceLock::STRIPE_SIZE;
+                 stripe <= (start + length - 1) / StripedSequenceLock::STRIPE_SIZE; ++stripe)
+                storeRelaxed(_stripes[stripe], version);
+        }
+
+        /**
+         * @brief Calls fn(start, count) for every maximal run of blocks of a stripe written after version since.
+         */
+        template<typename Function>
+        void forEachChangedRange(int stripe, uint64_t since, Function &&fn) const {
+            if (loadRelaxed(_stripes[stripe]) <= since)
+                return;
+            int first = stripe * BLOCKS_PER_STRIPE;
+            int runStart = -1;
+            for (int block = first; block < first + BLOCKS_PER_STRIPE; ++block) {
+                bool changed = loadRelaxed(_blocks[block]) > since;
+                if (changed && runStart < 0) {
+                    runStart = block;
+                } else if (!changed && runStart >= 0) {
+                    fn(runStart * BLOCK_SIZE, (block - runStart) * BLOCK_SIZE);
+                    runStart = -1;
+                }
+            }
+            if (runStart >= 0)
+                fn(runStart * BLOCK_SIZE, (first + BLOCKS_PER_STRIPE - runStart) * BLOCK_SIZE);
+        }
+
+    private:
+        std::array<uint64_t, BLOCK_COUNT> _blocks{};
+        std::array<uint64_t, StripedSequenceLock::STRIPE_COUNT> _stripes{};
+    };
+
+    /**
+     * @struct BooleanTable
+     * @brief Dense storage for a full table of coils or discrete inputs.
+     *
+     * Values are packed one bit per address and a second bitmap records which addresses exist. Writers update
+     * the table inside a write section of its striped sequence lock.
+     */
+    struct BooleanTable {
+        using value_type = bool;
+
+        AddressBitmap values;
+        AddressBitmap occupied;
+        BlockVersions versions;
+        StripedSequenceLock stripes;
+
+        bool read(int address) const {
+            return values.test(address);
+        }
+
+        void write(int address, bool value) {
+            values.set(address, value);
+        }
+
+        /**
+         * @brief Calls consumer(i, value) for the i-th value of [start, start + length).
+         */
+        template<typename Consumer>
+        void readRange(int start, int length, Consumer &&consumer) const {
+            values.readRange(start, length, std::forward<Consumer>(consumer));
+        }
+
+        /**
+         * @brief Sets the i-th value of [start, start + length) to valueAt(i).
+         */
+        template<typename ValueAt>
+        void writeRange(int start, int length, ValueAt &&valueAt) {
+            values.writeRange(start, length, std::forward<ValueAt>(valueAt));
+        }
+    };
+
+    /**
+     * @struct IntegerTable
+     * @brief Dense storage for a full table of holding or input registers.
+     *
+     * Values live in a contiguous array indexed by address, and a bitmap records which addresses exist. Writers
+     * update the table inside a write section of its striped sequence lock.
+     */
+    struct IntegerTable {
+        using value_type = uint16_t;
+
+        std::array<uint16_t, MAX_REGISTER_DATA_AREA_SIZE> values{};
+        AddressBitmap occupied;
+        BlockVersions versions;
+        StripedSequenceLock stripes;
+
+        uint16_t read(int address) const {
+            return loadRelaxed(values[address]);
+        }
+
+        void write(int address, uint16_t value) {
+            storeRelaxed(values[address], value);
+        }
+
+        /**
+         * @brief Calls consumer(i, value) for the i-th value of [start, start + length).
+         */
+        template<typename Consumer>
+        void readRange(int start, int length, Consumer &&consumer) const {
+            for (int i = 0; i < length; ++i)
+                consumer(i, read(start + i));
+        }
+
+        /**
+         * @brief Sets the i-th value of [start, start + length) to valueAt(i).
+         */
+        template<typename ValueAt>
+        void writeRange(int start, int length, ValueAt &&valueAt) {
+            for (int i = 0; i < length; ++i)
+                write(start + i, valueAt(i));
+        }
+    };
+
+    /**
+     * @enum TableType
+     * @brief Identifies one of the four Modbus tables of a data area.
+     */
+    enum class TableType {
+        Coils,
+        DiscreteInputs,
+        HoldingRegisters,
+        InputRegisters
+    };
+
+    /**
+     * @struct DataTables
+     * @brief The four Modbus tables of a data area, laid out in a single block.
+     *
+     * The block holds no pointer and all of its bytes being zero represents four empty tables, so it can live in a
+     * memory-mapped file as well as on the heap; see DataStore. Its layout is that of the files of
+     * MappedFileDataStore, which other processes may map to read the tables.
+     */
+    struct DataTables {
+        BooleanTable coils;
+        BooleanTable discreteInputs;
+        IntegerTable holdingRegisters;
+        IntegerTable inputRegisters;
+
+        /** The version of the last write to any table, see BlockVersions. */
+        std::atomic<uint64_t> version{0};
+
+        /**
+         * @brief Re-creates the writer locks and sequence counters of every table, unlocked.
+         *
+         * Used when a block is mapped from a file, where a process that stopped in the middle of a write may have
+         * left them locked, and to set up the locks of a new shared memory segment. Nothing may be using the tables
+         * meanwhile.
+         */
+        void resetLocks() {
+            for (auto *stripes: {&coils.stripes, &discreteInputs.stripes, &holdingRegisters.stripes,
+                                 &inputRegisters.stripes}) {
+                std::destroy_at(stripes);
+                std::construct_at(stripes);
+            }
+        }
+
+        /**
+         * @brief Calls fn with the table identified by type and returns its result.
+         *
+         * fn is called with either a BooleanTable or an IntegerTable, so it is usually a generic lambda.
+         */
+        template<typename Function>
+        decltype(auto) visit(TableType type, Function &&fn) {
+            return visit(*this, type, std::forward<Function>(fn));
+        }
+
+        template<typename Function>
+        decltype(auto) visit(TableType type, Function &&fn) const {
+            return visit(*this, type, std::forward<Function>(fn));
+        }
+
+    private:
+        template<typename Tables, typename Function>
+        static decltype(auto) visit(Tables &tables, TableType type, Function &&fn) {
+            switch (type) {
+                case TableType::Coils:
+                    return fn(tables.coils);
+                case TableType::DiscreteInputs:
+                    return fn(tables.discreteInputs);
+                case TableType::HoldingRegisters:
+                    return fn(tables.holdingRegisters);
+                case TableType::InputRegisters:
+                    return fn(tables.inputRegisters);
+            }
+            throw std::invalid_argument("Invalid table type.");
+        }
+    };
+}
+
+#endif //MBLIBRARY_MODBUSDATATABLE_H
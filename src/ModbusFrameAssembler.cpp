@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <stdexcept>
+#include "ModbusFrameAssembler.h"
+#include "ModbusUtilities.h"
+
+std::span<std::byte> Modbus::FrameAssembler::prepare() {
+    if (_begin != 0) {
+        std::copy(_buffer.begin() + _begin, _buffer.begin() + _end, _buffer.begin());
+        _end -= _begin;
+        _begin = 0;
+    }
+    return std::span<std::byte>(_buffer).subspan(_end);
+}
+
+void Modbus::FrameAssembler::commit(std::size_t bytes) {
+    if (bytes > _buffer.size() - _end)
+        throw std::out_of_range("Committed more bytes than the frame buffer can hold.");
+    _end += bytes;
+}
+
+std::optional<std::span<const std::byte>> Modbus::FrameAssembler::nextFrame() {
+    auto available = _end - _begin;
+    // The length field sits in bytes 4 and 5 of the MBAP header
+    if (available < Modbus::MBAP_HEADER_LENGTH)
+        return std::nullopt;
+
+    // The length counts the unit identifier and the PDU, which must at least hold a function code
+    auto length = Modbus::Utilities::twoBytesToUint16(_buffer[_begin + 4], _buffer[_begin + 5]);
+    if (length < 2 || length > Modbus::MAX_PDU_LENGTH + 1)
+        throw std::invalid_argument("Invalid MBAP length field.");
+
+    auto frameSize = static_cast<std::size_t>(Modbus::MBAP_HEADER_LENGTH - 1 + length);
+    if (available < frameSize)
+        return std::nullopt;
+
+    auto frame = std::span<const std::byte>(_buffer).subspan(_begin, frameSize);
+    _begin += frameSize;
+    return frame;
+}
+
+std::size_t Modbus::FrameAssembler::pendingBytes() const {
+    return _end - _begin;
+}
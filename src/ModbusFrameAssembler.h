@@ -0,0 +1,75 @@
+#ifndef MBLIBRARY_MODBUSFRAMEASSEMBLER_H
+#define MBLIBRARY_MODBUSFRAMEASSEMBLER_H
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include "ModbusPDU.h"
+
+namespace Modbus {
+
+    /**
+     * @class FrameAssembler
+     * @brief Splits a TCP byte stream into complete Modbus TCP frames (ADUs).
+     *
+     * A TCP read may return part of a frame, exactly one frame, or several pipelined frames. The assembler
+     * accumulates the received bytes in a per-connection buffer and uses the MBAP length field to cut out
+     * complete frames. Partial frames, including partial MBAP headers, stay in the buffer until the rest arrives.
+     *
+     * Typical use on a connection:
+     * @code{.cpp}
+     * FrameAssembler assembler;
+     * for (;;) {
+     *     auto received = socket.read_some(boost::asio::buffer(assembler.prepare()));
+     *     assembler.commit(received);
+     *     while (auto frame = assembler.nextFrame()) {
+     *         // handle *frame
+     *     }
+     * }
+     * @endcode
+     *
+     * Frames are returned as views into the internal buffer; a view stays valid until the next call to prepare().
+     */
+    class FrameAssembler {
+    public:
+        static constexpr std::size_t BUFFER_SIZE = 8 * MAX_ADU_LENGTH;
+
+        /**
+         * @brief Returns the writable space where the next received bytes must be stored.
+         *
+         * Bytes of frames already returned by nextFrame() are discarded and any partial frame is moved to the
+         * front of the buffer, so the returned space is always at least BUFFER_SIZE - MAX_ADU_LENGTH bytes.
+         */
+        std::span<std::byte> prepare();
+
+        /**
+         * @brief Marks the first bytes of the space returned by prepare() as received.
+         *
+         * @param bytes The number of bytes received.
+         * @throws std::out_of_range if more bytes are committed than prepare() made available.
+         */
+        void commit(std::size_t bytes);
+
+        /**
+         * @brief Extracts the next complete frame, if any.
+         *
+         * @return A view of the complete frame (MBAP header and PDU), or std::nullopt if more bytes are needed.
+         * @throws std::invalid_argument if the MBAP length field does not describe a valid Modbus TCP frame.
+         *         The stream cannot be resynchronized after this, so the connection should be closed.
+         */
+        std::optional<std::span<const std::byte>> nextFrame();
+
+        /**
+         * @brief Returns the number of buffered bytes not yet returned as frames.
+         */
+        std::size_t pendingBytes() const;
+
+    private:
+        std::array<std::byte, BUFFER_SIZE> _buffer{};
+        std::size_t _begin = 0;
+        std::size_t _end = 0;
+    };
+}
+
+#endif //MBLIBRARY_MODBUSFRAMEASSEMBLER_H
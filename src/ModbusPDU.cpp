@@ -1,9 +1,12 @@
+#include <algorithm>
+#include <array>
+#include <tuple>
 #include "Modbus.h"
 #include "ModbusPDU.h"
 #include "ModbusDataArea.h"
 
-Modbus::MBAP Modbus::bytesToMBAP(const std::vector<std::byte> &bytes) {
-    if (bytes.size() < 6)
+Modbus::MBAP Modbus::bytesToMBAP(std::span<const std::byte> bytes) {
+    if (bytes.size() < 7)
         throw std::invalid_argument("Invalid number of bytes for MBAP.");
     MBAP mbap{};
     mbap.transactionIdentifier = (uint16_t) bytes[0] << 8 | (uint16_t) bytes[1];
@@ -14,6 +17,50 @@ Modbus::MBAP Modbus::bytesToMBAP(const std::vector<std::byte> &bytes) {
     return mbap;
 }
 
+namespace {
+    /**
+     * @brief Returns the function code of a raw PDU.
+     *
+     * @throws std::invalid_argument if the PDU is empty.
+     */
+    Modbus::FunctionCode functionCodeOf(std::span<const std::byte> rawData) {
+        if (rawData.empty())
+            throw std::invalid_argument("A PDU must hold at least a function code.");
+        return Modbus::byteToModbusFunctionCode(rawData[0]);
+    }
+
+    /**
+     * @brief Returns the number of request bytes that follow the function code before any payload: the address and
+     * the quantity or value, then the byte count of the multiple writes. Unsupported function codes need none.
+     */
+    std::size_t requestHeaderLength(Modbus::FunctionCode functionCode) {
+        switch (functionCode) {
+            case Modbus::FunctionCode::ReadCoils:
+            case Modbus::FunctionCode::ReadDiscreteInputs:
+            case Modbus::FunctionCode::ReadHoldingRegisters:
+            case Modbus::FunctionCode::ReadInputRegister:
+            case Modbus::FunctionCode::WriteSingleCoil:
+            case Modbus::FunctionCode::WriteSingleRegister:
+                return 4;
+            case Modbus::FunctionCode::WriteMultipleCoils:
+            case Modbus::FunctionCode::WriteMultipleRegisters:
+                return 5;
+            default:
+                return 0;
+        }
+    }
+}
+
+std::size_t Modbus::writeMBAP(const MBAP &mbap, std::span<std::byte> out) {
+    if (out.size() < Modbus::MBAP_HEADER_LENGTH)
+        throw std::invalid_argument("Buffer too small for MBAP.");
+    std::tie(out[0], out[1]) = Modbus::Utilities::uint16ToTwoBytes(mbap.transactionIdentifier);
+    std::tie(out[2], out[3]) = Modbus::Utilities::uint16ToTwoBytes(mbap.protocolIdentifier);
+    std::tie(out[4], out[5]) = Modbus::Utilities::uint16ToTwoBytes(mbap.length);
+    out[6] = static_cast<std::byte>(mbap.unitIdentifier);
+    return Modbus::MBAP_HEADER_LENGTH;
+}
+
 std::vector<std::byte> Modbus::MBAPToBytes(const MBAP &mbap) {
     std::vector<std::byte> bytes;
     bytes.push_back((std::byte) (mbap.transactionIdentifier >> 8));
@@ -28,13 +75,20 @@ std::vector<std::byte> Modbus::MBAPToBytes(const MBAP &mbap) {
 
 
 Modbus::PDU::PDU(std::vector<std::byte> rawData, Modbus::DataArea &modbusDataArea)
-        : _functionCode(Modbus::byteToModbusFunctionCode(rawData[0])), _modbusDataArea(modbusDataArea) {
-    _data = std::vector<std::byte>(rawData.begin() + 1, rawData.end());
+        : _ownedData(std::move(rawData)), _functionCode(functionCodeOf(_ownedData)),
+          _modbusDataArea(modbusDataArea) {
+    _data = std::span<const std::byte>(_ownedData).subspan(1);
+}
+
+Modbus::PDU::PDU(std::span<const std::byte> rawData, Modbus::DataArea &modbusDataArea)
+        : _functionCode(functionCodeOf(rawData)), _modbusDataArea(modbusDataArea) {
+    _data = rawData.subspan(1);
 }
 
 Modbus::PDU::PDU(Modbus::FunctionCode functionCode, std::vector<std::byte> data,
-                 Modbus::DataArea &modbusDataArea) : _functionCode(functionCode),
-                                                     _data(std::move(data)),
+                 Modbus::DataArea &modbusDataArea) : _ownedData(std::move(data)),
+                                                     _data(_ownedData),
+                                                     _functionCode(functionCode),
                                                      _modbusDataArea(modbusDataArea) {
 
 }
@@ -44,26 +98,37 @@ Modbus::FunctionCode Modbus::PDU::getFunctionCode() {
 }
 
 std::vector<std::byte> Modbus::PDU::buildResponse() {
+    std::vector<std::byte> response(Modbus::MAX_PDU_LENGTH);
+    response.resize(buildResponse(response));
+    return response;
+}
+
+std::size_t Modbus::PDU::buildResponse(std::span<std::byte> out) {
+    if (out.size() < Modbus::MAX_PDU_LENGTH)
+        throw std::invalid_argument("Response buffer is smaller than the maximum PDU length.");
+    // The handlers read the request in place, so a truncated request must be answered before any of them runs
+    if (_data.size() < requestHeaderLength(_functionCode))
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataValue, out);
     switch (_functionCode) {
         case Modbus::FunctionCode::ReadCoils:
-            return getReadCoilsResponse();
+            return getReadCoilsResponse(out);
         case Modbus::FunctionCode::ReadDiscreteInputs:
-            return getReadDiscreteInputsResponse();
+            return getReadDiscreteInputsResponse(out);
         case Modbus::FunctionCode::ReadHoldingRegisters:
-            return getReadHoldingRegistersResponse();
+            return getReadHoldingRegistersResponse(out);
         case Modbus::FunctionCode::ReadInputRegister:
-            return getReadInputRegistersResponse();
+            return getReadInputRegistersResponse(out);
         case Modbus::FunctionCode::WriteSingleCoil:
-            return getWriteSingleCoilResponse();
+            return getWriteSingleCoilResponse(out);
         case Modbus::FunctionCode::WriteSingleRegister:
-            return getWriteSingleRegisterResponse();
+            return getWriteSingleRegisterResponse(out);
         case Modbus::FunctionCode::WriteMultipleCoils:
-            return getWriteMultipleCoilsResponse();
+            return getWriteMultipleCoilsResponse(out);
         case Modbus::FunctionCode::WriteMultipleRegisters:
-            return getWriteMultipleRegistersResponse();
+            return getWriteMultipleRegistersResponse(out);
         default:
             //  Build exception response for invalid function code
-            return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalFunction);
+            return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalFunction, out);
     }
 }
 
@@ -73,156 +138,123 @@ std::pair<uint16_t, uint16_t> Modbus::PDU::getStartingAddressAndQuantityOfRegist
     return {startingAddress, quantityOfRegisters};
 }
 
+std::size_t
+Modbus::PDU::buildResponseForBooleanRegisters(AccessResult (DataArea::*readPackedBits)(int, int, std::span<std::byte>),
+                                              std::span<std::byte> out) {
+    auto [startingAddress, quantityOfRegisters] = getStartingAddressAndQuantityOfRegisters();
 
-std::vector<std::byte> Modbus::PDU::getReadCoilsResponse() {
-    // Get the starting address and quantity of coils
-    auto [startingAddress, quantityOfCoils] = getStartingAddressAndQuantityOfRegisters();
-
-    try {
-        // Get the coils from the data area
-        auto coils = _modbusDataArea.getCoils(startingAddress, quantityOfCoils);
-        // Get the response
-        return buildResponseForBooleanRegisters(coils, startingAddress, quantityOfCoils);
-    } catch (std::out_of_range &e) {
-        // Build response for invalid address
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress);
-    }
+    // Read the registers from the data area straight into the response
+    if (!(_modbusDataArea.*readPackedBits)(startingAddress, quantityOfRegisters, out.subspan(2)))
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress, out);
+    auto byteCount = calculateBytesFromBits(quantityOfRegisters);
+    out[0] = static_cast<std::byte>(_functionCode);
+    out[1] = static_cast<std::byte>(byteCount);
+    return byteCount + 2;
 }
 
-std::vector<std::byte> Modbus::PDU::getReadDiscreteInputsResponse() {
+std::size_t
+Modbus::PDU::buildResponseForIntegerRegisters(AccessResult (DataArea::*readRegisters)(int, std::span<uint16_t>),
+                                              int maxQuantity, std::span<std::byte> out) {
     auto [startingAddress, quantityOfRegisters] = getStartingAddressAndQuantityOfRegisters();
-
-    try {
-        // Get the discrete inputs from the data area
-        auto discreteInputs = _modbusDataArea.getDiscreteInputs(startingAddress, quantityOfRegisters);
-        // Get the response
-        return buildResponseForBooleanRegisters(discreteInputs, startingAddress, quantityOfRegisters);
-    } catch (std::out_of_range &e) {
-        // Build response for invalid address
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress);
+    if (quantityOfRegisters > maxQuantity)
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress, out);
+
+    std::array<uint16_t, std::max(MAX_HOLDING_REGISTERS, MAX_INPUT_REGISTERS)> values{};
+    // Get the registers from the data area
+    if (!(_modbusDataArea.*readRegisters)(startingAddress, std::span(values).first(quantityOfRegisters)))
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress, out);
+    out[0] = static_cast<std::byte>(_functionCode);
+    out[1] = static_cast<std::byte>(quantityOfRegisters * 2);
+    for (int i = 0; i < quantityOfRegisters; ++i) {
+        auto [msb, lsb] = Modbus::Utilities::uint16ToTwoBytes(values[i]);
+        out[2 + i * 2] = msb;
+        out[3 + i * 2] = lsb;
     }
+    return 2 + quantityOfRegisters * 2;
 }
 
-std::vector<std::byte> Modbus::PDU::getReadHoldingRegistersResponse() {
-    auto [startingAddress, quantityOfRegisters] = getStartingAddressAndQuantityOfRegisters();
+std::size_t Modbus::PDU::buildEchoResponse(std::span<std::byte> out) {
+    out[0] = static_cast<std::byte>(_functionCode);
+    std::copy_n(_data.begin(), 4, out.begin() + 1);
+    return 5;
+}
 
-    try {
-        // Get the holding registers from the data area
-        auto holdingRegisters = _modbusDataArea.getHoldingRegisters(startingAddress, quantityOfRegisters);
-        // Get the response
-        return buildResponseForIntegerRegisters(holdingRegisters, startingAddress, quantityOfRegisters);
+std::size_t Modbus::PDU::getReadCoilsResponse(std::span<std::byte> out) {
+    return buildResponseForBooleanRegisters(&DataArea::tryReadCoils, out);
+}
 
-    } catch (std::out_of_range &e) {
-        // Build response for invalid address
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress);
-    }
+std::size_t Modbus::PDU::getReadDiscreteInputsResponse(std::span<std::byte> out) {
+    return buildResponseForBooleanRegisters(&DataArea::tryReadDiscreteInputs, out);
 }
 
-std::vector<std::byte> Modbus::PDU::getReadInputRegistersResponse() {
-    auto [startingAddress, quantityOfRegisters] = getStartingAddressAndQuantityOfRegisters();
+std::size_t Modbus::PDU::getReadHoldingRegistersResponse(std::span<std::byte> out) {
+    return buildResponseForIntegerRegisters(&DataArea::tryReadHoldingRegisters, MAX_HOLDING_REGISTERS, out);
+}
 
-    try {
-        // Get the input registers from the data area
-        auto inputRegisters = _modbusDataArea.getInputRegisters(startingAddress, quantityOfRegisters);
-        // Get the response
-        return buildResponseForIntegerRegisters(inputRegisters, startingAddress, quantityOfRegisters);
-    } catch (std::out_of_range &e) {
-        // Build response for invalid address
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress);
-    }
+std::size_t Modbus::PDU::getReadInputRegistersResponse(std::span<std::byte> out) {
+    return buildResponseForIntegerRegisters(&DataArea::tryReadInputRegisters, MAX_INPUT_REGISTERS, out);
 }
 
-std::vector<std::byte> Modbus::PDU::getWriteSingleCoilResponse() {
+std::size_t Modbus::PDU::getWriteSingleCoilResponse(std::span<std::byte> out) {
     auto [address, value] = getStartingAddressAndQuantityOfRegisters();
     bool coilValue = false;
     if (value != 0xFF00 && value != 0x0000) {
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataValue);
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataValue, out);
     } else {
         coilValue = (value == 0xFF00);
     }
 
-    try {
-        _modbusDataArea.writeSingletCoil(address, coilValue);
-        return {static_cast<std::byte>(Modbus::FunctionCode::WriteSingleCoil), _data[0], _data[1],
-                _data[2], _data[3]};
-    } catch (std::out_of_range &e) {
-        return Modbus::buildExceptionResponse(_functionCode,
-                                              Modbus::ExceptionCode::IllegalDataAddress);
-    }
+    if (!_modbusDataArea.tryWriteSingleCoil(address, coilValue))
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress, out);
+    return buildEchoResponse(out);
 }
 
-std::vector<std::byte> Modbus::PDU::getWriteSingleRegisterResponse() {
+std::size_t Modbus::PDU::getWriteSingleRegisterResponse(std::span<std::byte> out) {
     auto [address, value] = getStartingAddressAndQuantityOfRegisters();
-    try {
-        _modbusDataArea.writeSingleRegister(address, value);
-        return {static_cast<std::byte>(Modbus::FunctionCode::WriteSingleRegister), _data[0], _data[1], _data[2],
-                _data[3]};
-    } catch (std::out_of_range &e) {
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress);
-    }
+    if (!_modbusDataArea.tryWriteSingleRegister(address, value))
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress, out);
+    return buildEchoResponse(out);
 }
 
-std::vector<std::byte> Modbus::PDU::getWriteMultipleCoilsResponse() {
+std::size_t Modbus::PDU::getWriteMultipleCoilsResponse(std::span<std::byte> out) {
     auto [startingAddress, quantityOfCoils] = getStartingAddressAndQuantityOfRegisters();
     auto byteCountFromRawData = static_cast<int>(_data[4]);
     auto requiredBytesForNumberOfCoils = calculateBytesFromBits(quantityOfCoils);
 
-
-    if ((quantityOfCoils < 0) || (quantityOfCoils > MAX_COILS) ||
-        (byteCountFromRawData != requiredBytesForNumberOfCoils) || (requiredBytesForNumberOfCoils > _data.size() - 5)) {
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataValue);
-    }
-
-    // Check if range is valid
-    try {
-        auto coils = _modbusDataArea.getCoils(startingAddress, quantityOfCoils);
-    }
-    catch (std::out_of_range &e) {
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress);
-    }
-
-    // Request is valid, unpack the booleans
-    std::vector<bool> unpackedBooleans{};
-    // TODO: Implement a more efficient way to unpack the booleans
-    for (int i = 0; i < byteCountFromRawData; ++i) {
-        auto byte = static_cast<uint8_t>(_data[5 + i]);
-        for (int j = 0; j < 8; ++j) {
-            unpackedBooleans.push_back((byte & (1 << j)) != 0);
-        }
+    // The request header was checked by buildResponse(), so the payload length cannot wrap around
+    auto payloadLength = _data.size() - 5;
+    if ((quantityOfCoils > MAX_COILS) || (byteCountFromRawData != requiredBytesForNumberOfCoils) ||
+        (static_cast<std::size_t>(byteCountFromRawData) > payloadLength)) {
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataValue, out);
     }
 
     //TODO: Implement Exception code 4 for Modbus::ExceptionCode::ServerDeviceFailure
-    for (int i = 0; i < quantityOfCoils; ++i) {
-        _modbusDataArea.writeSingletCoil(startingAddress + i, unpackedBooleans[i]);
-    }
-    return {static_cast<std::byte>(_functionCode), _data[0], _data[1], _data[2],
-            _data[3]};
+    auto packedCoils = _data.subspan(5, byteCountFromRawData);
+    if (!_modbusDataArea.tryWriteCoils(startingAddress, quantityOfCoils, packedCoils))
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress, out);
+    return buildEchoResponse(out);
 }
 
-std::vector<std::byte> Modbus::PDU::getWriteMultipleRegistersResponse() {
+std::size_t Modbus::PDU::getWriteMultipleRegistersResponse(std::span<std::byte> out) {
     auto [startingAddress, quantityOfRegisters] = getStartingAddressAndQuantityOfRegisters();
     auto byteCount = static_cast<int>(_data[4]);
 
-    if ((quantityOfRegisters < 0) || (quantityOfRegisters > MAX_HOLDING_REGISTERS) ||
-        (byteCount != quantityOfRegisters * 2) || (quantityOfRegisters * 2 > _data.size() - 5)) {
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataValue);
+    auto payloadLength = _data.size() - 5;
+    if ((quantityOfRegisters > MAX_HOLDING_REGISTERS) || (byteCount != quantityOfRegisters * 2) ||
+        (static_cast<std::size_t>(byteCount) > payloadLength)) {
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataValue, out);
     }
 
-    // Check if range is valid
-    try {
-        auto holdingRegisters = _modbusDataArea.getHoldingRegisters(startingAddress, quantityOfRegisters);
-    } catch (std::out_of_range &e) {
-        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress);
+    // Decode the register values, then commit them in a single write
+    std::array<uint16_t, MAX_HOLDING_REGISTERS> values{};
+    for (int i = 0; i < quantityOfRegisters; ++i) {
+        values[i] = Modbus::Utilities::twoBytesToUint16(_data[5 + i * 2], _data[6 + i * 2]);
     }
 
-    // Process the request
     //TODO: Implement Exception code 4 for Modbus::ExceptionCode::ServerDeviceFailure
-    for (int i = 0; i < quantityOfRegisters; ++i) {
-        auto value = Modbus::Utilities::twoBytesToUint16(_data[5 + i * 2], _data[6 + i * 2]);
-        _modbusDataArea.writeSingleRegister(startingAddress + i, value);
-    }
-    return {static_cast<std::byte>(_functionCode), _data[0], _data[1], _data[2],
-            _data[3]};
+    if (!_modbusDataArea.tryWriteHoldingRegisters(startingAddress, std::span(values).first(quantityOfRegisters)))
+        return Modbus::buildExceptionResponse(_functionCode, Modbus::ExceptionCode::IllegalDataAddress, out);
+    return buildEchoResponse(out);
 }
 
 std::vector<std::byte>
@@ -230,3 +262,10 @@ Modbus::buildExceptionResponse(Modbus::FunctionCode functionCode, Modbus::Except
     return {static_cast<std::byte>(0x80 + static_cast<uint8_t>(functionCode)),
             static_cast<std::byte>(exceptionCode)};
 }
+
+std::size_t Modbus::buildExceptionResponse(Modbus::FunctionCode functionCode, Modbus::ExceptionCode exceptionCode,
+                                           std::span<std::byte> out) {
+    out[0] = static_cast<std::byte>(0x80 + static_cast<uint8_t>(functionCode));
+    out[1] = static_cast<std::byte>(exceptionCode);
+    return 2;
+}
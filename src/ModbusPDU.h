@@ -8,11 +8,15 @@
 #include <cstddef>
 #include <vector>
 #include <memory>
+#include <span>
 #include "Modbus.h"
 #include "ModbusDataArea.h"
 #include "ModbusUtilities.h"
 
 namespace Modbus {
+    constexpr int MBAP_HEADER_LENGTH = 7; // Size of the Modbus Application Protocol header
+    constexpr int MAX_PDU_LENGTH = 253; // Largest PDU allowed by the Modbus specification
+    constexpr int MAX_ADU_LENGTH = MBAP_HEADER_LENGTH + MAX_PDU_LENGTH; // Largest Modbus TCP frame, 260 bytes
 
     /**
      * @file MBAP.h
@@ -28,12 +32,15 @@ namespace Modbus {
 
 
     /**
-     * @brief Convert a vector of bytes to a MBAP (Modbus Application Protocol) structure.
+     * @brief Convert a sequence of bytes to a MBAP (Modbus Application Protocol) structure.
      *
-     * @param bytes The vector containing the bytes to be converted.
+     * The bytes are only read, so the function can parse the header in place from a receive buffer.
+     *
+     * @param bytes A view of at least the 7 header bytes to be converted.
      * @return The converted MBAP structure.
+     * @throws std::invalid_argument if fewer than 7 bytes are provided.
      */
-    MBAP bytesToMBAP(const std::vector<std::byte> &bytes);
+    MBAP bytesToMBAP(std::span<const std::byte> bytes);
 
     /**
      * @brief Converts a Modbus Application Protocol (MBAP) structure to a byte array
@@ -47,6 +54,17 @@ namespace Modbus {
      */
     std::vector<std::byte> MBAPToBytes(const MBAP &mbap);
 
+    /**
+     * @brief Writes a Modbus Application Protocol (MBAP) structure into a caller-provided buffer.
+     *
+     * @param mbap The MBAP structure to be written
+     * @param out The output buffer; must hold at least MBAP_HEADER_LENGTH bytes
+     * @return The number of bytes written, MBAP_HEADER_LENGTH
+     *
+     * @see MBAPToBytes()
+     */
+    std::size_t writeMBAP(const MBAP &mbap, std::span<std::byte> out);
+
 
     /**
          * @class PDU
@@ -65,12 +83,33 @@ namespace Modbus {
          * This class encapsulates the raw data and provides methods to access and manipulate
          * the contents of the PDU. It is used in conjunction with DataArea to assist in
          * Modbus communication.
+         *
+         * This constructor takes ownership of the raw data (function code followed by the request data).
+         *
+         * @throws std::invalid_argument if the raw data is empty.
          */
         explicit PDU(std::vector<std::byte> rawData, Modbus::DataArea &modbusDataArea);
 
+        /**
+         * @brief Creates a PDU that views raw data owned by the caller.
+         *
+         * Nothing is copied: the PDU parses the request directly from the given bytes, which must outlive the PDU.
+         * This is the constructor used by the server to parse requests in place from the receive buffer.
+         *
+         * @param rawData The function code followed by the request data.
+         * @param modbusDataArea The data area the request operates on.
+         * @throws std::invalid_argument if the raw data is empty.
+         */
+        explicit PDU(std::span<const std::byte> rawData, Modbus::DataArea &modbusDataArea);
+
         PDU(Modbus::FunctionCode functionCode, std::vector<std::byte> data,
             Modbus::DataArea &modbusDataArea);
 
+        // The request data may point into _ownedData, so a copy would dangle.
+        PDU(const PDU &) = delete;
+
+        PDU &operator=(const PDU &) = delete;
+
 
         /**
          * @brief Get the function code of the Modbus PDU.
@@ -90,9 +129,22 @@ namespace Modbus {
          */
         std::vector<std::byte> buildResponse();
 
+        /**
+         * @brief Builds the response for the request directly into a caller-provided buffer.
+         *
+         * This is the allocation-free variant of buildResponse(): the response PDU is written at the start of
+         * out, which is typically the PDU part of a preallocated frame buffer of MAX_ADU_LENGTH bytes.
+         *
+         * @param out The output buffer; must hold at least MAX_PDU_LENGTH bytes.
+         * @return The number of bytes of the response PDU.
+         * @throws std::invalid_argument if out is smaller than MAX_PDU_LENGTH.
+         */
+        std::size_t buildResponse(std::span<std::byte> out);
+
 
     private:
-        std::vector<std::byte> _data;
+        std::vector<std::byte> _ownedData;
+        std::span<const std::byte> _data;
         FunctionCode _functionCode;
         DataArea &_modbusDataArea;
 
@@ -125,18 +177,18 @@ namespace Modbus {
          *
          * @return The response as a vector of bytes.
          */
-        std::vector<std::byte> getReadCoilsResponse();
+        std::size_t getReadCoilsResponse(std::span<std::byte> out);
 
         /**
          * @file
          * @brief Contains the declaration of the getReadDiscreteInputsResponse() function.
          */
-        std::vector<std::byte> getReadDiscreteInputsResponse();
+        std::size_t getReadDiscreteInputsResponse(std::span<std::byte> out);
 
         /**
         *
         */
-        std::vector<std::byte> getReadHoldingRegistersResponse();
+        std::size_t getReadHoldingRegistersResponse(std::span<std::byte> out);
 
         /**
          * @brief Function to get the response from reading input registers.
@@ -145,7 +197,7 @@ namespace Modbus {
          *
          * @return ReadInputRegistersResponse - The response from reading input register(s).
          */
-        std::vector<std::byte> getReadInputRegistersResponse();
+        std::size_t getReadInputRegistersResponse(std::span<std::byte> out);
 
         /**
          * @brief Returns the response for a Write Single Coil request.
@@ -155,7 +207,7 @@ namespace Modbus {
          *
          * @return The response byte array for Write Single Coil request.
          */
-        std::vector<std::byte> getWriteSingleCoilResponse();
+        std::size_t getWriteSingleCoilResponse(std::span<std::byte> out);
 
         /**
          * @brief Returns the response from writing a single register.
@@ -164,7 +216,7 @@ namespace Modbus {
          *
          * @return The response data received after writing a single register.
          */
-        std::vector<std::byte> getWriteSingleRegisterResponse();
+        std::size_t getWriteSingleRegisterResponse(std::span<std::byte> out);
 
         /**
          * @brief Retrieves the response from the Modbus server after writing multiple coils.
@@ -174,7 +226,7 @@ namespace Modbus {
          *
          * @return The response data from the Modbus server for writing multiple coils.
          */
-        std::vector<std::byte> getWriteMultipleCoilsResponse();
+        std::size_t getWriteMultipleCoilsResponse(std::span<std::byte> out);
 
         /**
          * @brief Retrieves the response for "Write Multiple Registers" function code.
@@ -187,72 +239,41 @@ namespace Modbus {
          *
          * @return True if the response indicates a successful operation, false otherwise.
          */
-        std::vector<std::byte> getWriteMultipleRegistersResponse();
+        std::size_t getWriteMultipleRegistersResponse(std::span<std::byte> out);
 
 
         /**
          * @brief Builds the response for boolean registers.
          *
-         * This function takes a vector of boolean registers, starting address, and quantity of registers as input,
-         * and builds the response for the boolean registers based on the Modbus protocol.
-         * The response is returned as a vector of bytes.
-         *
-         * @tparam T The type of the boolean registers.
-         * @param booleanRegisters The vector of boolean registers.
-         * @param startingAddress The starting address of the registers.
-         * @param quantityOfRegisters The quantity of registers.
-         * @return The response as a vector of bytes.
+         * Writes the function code and byte count, then reads the requested range from the data area straight
+         * into the response as packed bits.
          *
-         * @see packBooleanRegistersIntoBytes
-         * @see calculateBytesFromBits
+         * @param readPackedBits The DataArea member reading packed bits (tryReadCoils or tryReadDiscreteInputs).
+         * @param out The output buffer.
+         * @return The number of bytes of the response.
          */
-        template<typename T>
-        std::vector<std::byte>
-        buildResponseForBooleanRegisters(std::vector<T> &booleanRegisters, int startingAddress,
-                                         int quantityOfRegisters) {
-            // Build the response
-            auto byteCount = calculateBytesFromBits(booleanRegisters.size());
-            auto functionCodeByte = static_cast<std::byte>(_functionCode);
-            std::vector<std::byte> response(byteCount + 2);
-            response[0] = functionCodeByte;
-            response[1] = static_cast<std::byte>(byteCount);
-            // Pack the coils into bytes
-            auto packedBits = Utilities::packBooleanRegistersIntoBytes(booleanRegisters);
-            // Copy the packed bits into the response
-            std::copy(packedBits.begin(), packedBits.end(), response.begin() + 2);
-            return response;
-        }
+        std::size_t
+        buildResponseForBooleanRegisters(AccessResult (DataArea::*readPackedBits)(int, int, std::span<std::byte>),
+                                         std::span<std::byte> out);
 
         /**
          * @brief Builds the response for integer registers.
          *
-         * This function takes a vector of integer registers, starting address, and quantity of registers
-         * as input, and builds the response for the integer registers based on the Modbus protocol.
-         * The response is returned as a vector of bytes.
-         *
-         * @tparam T The type of the integer registers.
-         * @param integerRegisters The vector of integer registers.
-         * @param startingAddress The starting address of the registers.
-         * @param quantityOfRegisters The quantity of registers.
-         * @return The response as a vector of bytes.
+         * Writes the function code and byte count, then the register values in big-endian order.
          *
-         * @see packIntegerRegistersIntoBytes
-         * @see calculateBytesFromIntegerRegisters
+         * @param readRegisters The DataArea member reading registers (tryReadHoldingRegisters or
+         * tryReadInputRegisters).
+         * @param maxQuantity The maximum number of registers allowed for the function.
+         * @param out The output buffer.
+         * @return The number of bytes of the response.
+         */
+        std::size_t buildResponseForIntegerRegisters(AccessResult (DataArea::*readRegisters)(int, std::span<uint16_t>),
+                                                     int maxQuantity, std::span<std::byte> out);
+
+        /**
+         * @brief Echoes the first four bytes of the request data (address and value/quantity) as the response.
          */
-        template<typename T>
-        std::vector<std::byte>
-        buildResponseForIntegerRegisters(std::vector<T> &integerRegisters, int startingAddress,
-                                         int quantityOfRegisters) {
-            //Build the response
-            auto byteCount = quantityOfRegisters * 2;
-            auto functionCodeByte = static_cast<std::byte>(_functionCode);
-            std::vector<std::byte> response(byteCount + 2);
-            response[0] = functionCodeByte;
-            response[1] = static_cast<std::byte>(byteCount);
-            std::vector<std::byte> packedBytes = Utilities::packIntegerRegistersIntoBytes(integerRegisters);
-            std::copy(packedBytes.begin(), packedBytes.end(), response.begin() + 2);
-            return response;
-        }
+        std::size_t buildEchoResponse(std::span<std::byte> out);
     };
 
     /**
@@ -274,6 +295,17 @@ namespace Modbus {
      */
     std::vector<std::byte>
     buildExceptionResponse(Modbus::FunctionCode functionCode, Modbus::ExceptionCode exceptionCode);
+
+    /**
+     * @brief Writes an exception response for Modbus protocol into a caller-provided buffer.
+     *
+     * @param functionCode The function code representing the operation that caused the exception.
+     * @param exceptionCode The exception code indicating the error condition.
+     * @param out The output buffer; must hold at least 2 bytes.
+     * @return The number of bytes written, 2.
+     */
+    std::size_t buildExceptionResponse(Modbus::FunctionCode functionCode, Modbus::ExceptionCode exceptionCode,
+                                       std::span<std::byte> out);
 }
 
 
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <array>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include "ModbusPollScheduler.h"
+#include "ModbusUtilities.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Checks whether an address of a table exists in the mirror.
+     */
+    bool existsInMirror(Modbus::DataArea &mirror, Modbus::TableType table, int address) {
+        std::array<std::byte, 1> bits{};
+        std::array<uint16_t, 1> value{};
+        switch (table) {
+            case Modbus::TableType::Coils:
+                return mirror.tryReadCoils(address, 1, bits).has_value();
+            case Modbus::TableType::DiscreteInputs:
+                return mirror.tryReadDiscreteInputs(address, 1, bits).has_value();
+            case Modbus::TableType::HoldingRegisters:
+                return mirror.tryReadHoldingRegisters(address, value).has_value();
+            case Modbus::TableType::InputRegisters:
+                return mirror.tryReadInputRegisters(address, value).has_value();
+        }
+        return false;
+    }
+
+    /**
+     * @brief Creates a range of addresses of a table in the mirror, as zeros.
+     */
+    void generateInMirror(Modbus::DataArea &mirror, Modbus::TableType table, int startAddress, int count) {
+        switch (table) {
+            case Modbus::TableType::Coils:
+                mirror.generateCoils(startAddress, count);
+                break;
+            case Modbus::TableType::DiscreteInputs:
+                mirror.generateDiscreteInputs(startAddress, count);
+                break;
+            case Modbus::TableType::HoldingRegisters:
+                mirror.generateHoldingRegisters(startAddress, count);
+                break;
+            case Modbus::TableType::InputRegisters:
+                mirror.generateInputRegisters(startAddress, count);
+                break;
+        }
+    }
+
+    /**
+     * @brief Creates the addresses read by a request that the mirror lacks.
+     *
+     * The range may overlap the plan of another scan class of the device, or registers the mirror already held,
+     * such as those restored from a mapped file; those are kept with their values.
+     */
+    void createInMirror(Modbus::DataArea &mirror, const Modbus::ReadPlan::Request &request) {
+        int end = request.startAddress + request.quantity;
+        for (int address = request.startAddress; address < end;) {
+            if (existsInMirror(mirror, request.table, address)) {
+                ++address;
+                continue;
+            }
+            int missingStart = address;
+            while (address < end && !existsInMirror(mirror, request.table, address))
+                ++address;
+            generateInMirror(mirror, request.table, missingStart, address - missingStart);
+        }
+    }
+
+    /**
+     * @brief Copies the block read by a request into the mirror, with a single write.
+     */
+    void publish(Modbus::DataArea &mirror, const Modbus::ReadPlan::Request &request,
+                 std::span<const std::byte> response) {
+        // The values follow the function code and the byte count; bits stay packed as the data area takes them
+        auto data = response.subspan(2);
+        std::array<uint16_t, Modbus::ClientProtocol::MAX_READ_REGISTERS> registers{};
+        auto values = std::span(registers).first(request.quantity);
+        switch (request.table) {
+            case Modbus::TableType::Coils:
+                mirror.writeCoils(request.startAddress, request.quantity, data);
+                break;
+            case Modbus::TableType::DiscreteInputs:
+                mirror.writeDiscreteInputs(request.startAddress, request.quantity, data);
+                break;
+            case Modbus::TableType::HoldingRegisters:
+            case Modbus::TableType::InputRegisters:
+                for (std::size_t i = 0; i < values.size(); ++i)
+                    values[i] = Modbus::Utilities::twoBytesToUint16(data[i * 2], data[i * 2 + 1]);
+                if (request.table == Modbus::TableType::HoldingRegisters)
+                    mirror.writeHoldingRegisters(request.startAddress, values);
+                else
+                    mirror.writeInputRegisters(request.startAddress, values);
+                break;
+        }
+    }
+}
+
+std::chrono::microseconds Modbus::ScanClassStatistics::meanJitter() const {
+    return scans == 0 ? std::chrono::microseconds(0) : totalJitter / static_cast<int64_t>(scans);
+}
+
+struct Modbus::PollScheduler::Device {
+    AsyncClient *client;
+    DataArea *mirror;
+};
+
+/**
+ * @brief The tags of one device at one scan rate, read by a single plan.
+ */
+struct Modbus::PollScheduler::PollGroup {
+    std::size_t device;
+    ReadPlan plan;
+    bool busy = false;
+};
+
+struct Modbus::PollScheduler::ScanClass {
+    ScanClass(const boost::asio::any_io_executor &executor, std::chrono::milliseconds scanRate) : timer(executor) {
+        statistics.scanRate = scanRate;
+    }
+
+    std::vector<PollGroup> groups;
+    boost::asio::steady_timer timer;
+    ScanClassStatistics statistics;
+};
+
+struct Modbus::PollScheduler::State {
+    explicit State(boost::asio::any_io_executor executor) : executor(std::move(executor)) {}
+
+    boost::asio::any_io_executor executor;
+    std::vector<Device> devices;
+    // The points of every device by scan rate, until start() plans them
+    std::map<std::pair<std::chrono::milliseconds, std::size_t>, std::vector<ReadPoint>> tags;
+    // Not resized once started, as the coroutines hold references to the scan classes and their groups
+    std::vector<std::unique_ptr<ScanClass>> scanClasses;
+    bool started = false;
+    bool stopped = false;
+};
+
+Modbus::PollScheduler::PollScheduler(boost::asio::any_io_executor executor)
+        : _state(std::make_shared<State>(std::move(executor))) {
+}
+
+Modbus::PollScheduler::~PollScheduler() {
+    stop();
+}
+
+std::size_t Modbus::PollScheduler::addDevice(AsyncClient &client, DataArea &mirror) {
+    if (_state->started)
+        throw std::invalid_argument("Devices cannot be added to a started scheduler.");
+    _state->devices.push_back({&client, &mirror});
+    return _state->devices.size() - 1;
+}
+
+void Modbus::PollScheduler::addTag(std::size_t device, ReadPoint point, std::chrono::milliseconds scanRate) {
+    if (_state->started)
+        throw std::invalid_argument("Tags cannot be added to a started scheduler.");
+    if (device >= _state->devices.size())
+        throw std::invalid_argument("Unknown device.");
+    if (scanRate.count() <= 0)
+        throw std::invalid_argument("The scan rate must be positive.");
+    _state->tags[{scanRate, device}].push_back(point);
+}
+
+void Modbus::PollScheduler::start(ReadPlanOptions options) {
+    if (_state->started)
+        throw std::invalid_argument("The scheduler is already started.");
+    ReadPlan(std::span<const ReadPoint>(), options); // Rejects invalid options even without tags
+
+    // Every plan is built before anything changes, so a throwing plan leaves the scheduler as it was. The tags are
+    // ordered by scan rate, then device: one scan class per rate, one group per device of the rate.
+    std::vector<std::unique_ptr<ScanClass>> scanClasses;
+    for (auto &[key, points]: _state->tags) {
+        auto [scanRate, device] = key;
+        if (scanClasses.empty() || scanClasses.back()->statistics.scanRate != scanRate)
+            scanClasses.push_back(std::make_unique<ScanClass>(_state->executor, scanRate));
+        scanClasses.back()->groups.push_back({device, ReadPlan(points, options)});
+    }
+
+    for (const auto &scanClass: scanClasses) {
+        for (const auto &group: scanClass->groups) {
+            for (const auto &request: group.plan.requests())
+                createInMirror(*_state->devices[group.device].mirror, request);
+        }
+    }
+
+    _state->scanClasses = std::move(scanClasses);
+    _state->tags.clear();
+    _state->started = true;
+    for (auto &scanClass: _state->scanClasses)
+        boost::asio::co_spawn(_state->executor, scan(_state, *scanClass), boost::asio::detached);
+}
+
+void Modbus::PollScheduler::stop() {
+    _state->stopped = true;
+    for (auto &scanClass: _state->scanClasses)
+        scanClass->timer.cancel();
+}
+
+std::vector<Modbus::ScanClassStatistics> Modbus::PollScheduler::statistics() const {
+    std::vector<ScanClassStatistics> statistics;
+    for (const auto &scanClass: _state->scanClasses)
+        statistics.push_back(scanClass->statistics);
+    return statistics;
+}
+
+boost::asio::awaitable<void> Modbus::PollScheduler::scan(std::shared_ptr<State> state, ScanClass &scanClass) {
+    auto &statistics = scanClass.statistics;
+    auto scanRate = statistics.scanRate;
+    auto next = Clock::now();
+    while (!state->stopped) {
+        // Waiting for an absolute time keeps the scans on the grid of the first one, whatever the polls take
+        scanClass.timer.expires_at(next);
+        boost::system::error_code ignored;
+        co_await scanClass.timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ignored));
+        if (state->stopped)
+            break;
+
+        auto now = Clock::now();
+        auto jitter = std::chrono::duration_cast<std::chrono::microseconds>(now - next);
+        ++statistics.scans;
+        statistics.lastJitter = jitter;
+        statistics.maxJitter = std::max(statistics.maxJitter, jitter);
+        statistics.totalJitter += jitter;
+
+        for (auto &group: scanClass.groups) {
+            if (group.busy) {
+                ++statistics.overruns;
+                continue;
+            }
+            group.busy = true;
+            boost::asio::co_spawn(state->executor, poll(state, scanClass, group), boost::asio::detached);
+        }
+
+        next += scanRate;
+        // Scans that should already have fired are dropped rather than fired back to back
+        auto missed = (now - next) / scanRate;
+        if (missed > 0) {
+            statistics.missedScans += missed;
+            next += missed * scanRate;
+        }
+    }
+}
+
+boost::asio::awaitable<void>
+Modbus::PollScheduler::poll(std::shared_ptr<State> state, ScanClass &scanClass, PollGroup &group) {
+    auto &device = state->devices[group.device];
+    try {
+        co_await device.client->read(group.plan, [&device, &group](std::size_t request,
+                                                                   std::span<const std::byte> response) {
+            publish(*device.mirror, group.plan.requests()[request], response);
+        });
+    } catch (const std::exception &) {
+        ++scanClass.statistics.failedPolls;
+    }
+    group.busy = false;
+}
@@ -0,0 +1,136 @@
+#ifndef MBLIBRARY_MODBUSPOLLSCHEDULER_H
+#define MBLIBRARY_MODBUSPOLLSCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/asio.hpp>
+#include "ModbusAsyncClient.h"
+#include "ModbusDataArea.h"
+#include "ModbusReadPlan.h"
+
+namespace Modbus {
+
+    /**
+     * @struct ScanClassStatistics
+     * @brief The timing counters of the tags polled at one scan rate.
+     */
+    struct ScanClassStatistics {
+        std::chrono::milliseconds scanRate{0};
+
+        /// The scans fired, each polling every device of the class.
+        uint64_t scans = 0;
+
+        /// The device polls skipped because the previous poll of the device at this rate was still running.
+        uint64_t overruns = 0;
+
+        /// The scans skipped entirely because the executor fell more than a scan behind.
+        uint64_t missedScans = 0;
+
+        /// The device polls that failed: exception responses, timeouts and closed connections.
+        uint64_t failedPolls = 0;
+
+        /// How late the scans fired after their scheduled time.
+        std::chrono::microseconds lastJitter{0};
+        std::chrono::microseconds maxJitter{0};
+        std::chrono::microseconds totalJitter{0};
+
+        std::chrono::microseconds meanJitter() const;
+    };
+
+    /**
+     * @class PollScheduler
+     * @brief Polls the tags of many devices cyclically, each at its own scan rate, into local DataArea mirrors.
+     *
+     * Tags are grouped by scan rate, the scan classes, and by device. start() builds one ReadPlan per group, once,
+     * and runs a timer per scan class. Scans are scheduled at fixed times, start + n * rate, so that the time
+     * taken by a scan does not accumulate as drift. At every scan each group of the class sends its plan through
+     * its device's AsyncClient, up to the client's window at a time, and copies the response blocks into the
+     * device's mirror, where they can be read, subscribed to or served by an MBServer.
+     *
+     * A group whose previous poll is still running when its next scan fires is skipped and counted as an overrun,
+     * rather than queued: a slow device falls back to the rate it can sustain instead of piling up requests. A
+     * scheduler that falls a whole scan behind, such as after the executor was blocked, skips the missed scans.
+     *
+     * The scheduler and its clients must use the same executor, which must not run handlers concurrently (see
+     * AsyncClient). The caller connects the clients, and reconnects them after failures; polls of a disconnected
+     * client fail and are counted. The clients and mirrors must outlive the scheduler's polls.
+     *
+     * @par Example
+     * @code{.cpp}
+     * Modbus::PollScheduler scheduler(context.get_executor());
+     * auto pump = scheduler.addDevice(pumpClient, pumpMirror);
+     * scheduler.addTag(pump, {Modbus::TableType::HoldingRegisters, 1000}, std::chrono::milliseconds(100));
+     * scheduler.addTag(pump, {Modbus::TableType::Coils, 12}, std::chrono::seconds(1));
+     * scheduler.start();
+     * context.run();
+     * @endcode
+     */
+    class PollScheduler {
+    public:
+        explicit PollScheduler(boost::asio::any_io_executor executor);
+
+        ~PollScheduler();
+
+        PollScheduler(const PollScheduler &) = delete;
+        PollScheduler &operator=(const PollScheduler &) = delete;
+
+        /**
+         * @brief Adds a device, polled through client into mirror, at the device's own addresses.
+         *
+         * @return The identifier of the device for addTag().
+         * @throws std::invalid_argument if the scheduler is started.
+         */
+        std::size_t addDevice(AsyncClient &client, DataArea &mirror);
+
+        /**
+         * @brief Adds a tag of a device, read every scanRate.
+         *
+         * @throws std::invalid_argument if the device is unknown, the scan rate is not positive, or the scheduler
+         * is started.
+         */
+        void addTag(std::size_t device, ReadPoint point, std::chrono::milliseconds scanRate);
+
+        /**
+         * @brief Plans the requests of every group and starts the scans; the first scan of every class fires at
+         * once.
+         *
+         * The addresses read by the plans that a mirror lacks are created in it, as zeros until their first poll;
+         * the addresses it already holds, such as those restored from a mapped file, keep their values. Nothing
+         * changes if a plan cannot be built.
+         *
+         * @param options How the tags of a group are coalesced into requests.
+         * @throws std::invalid_argument if the scheduler is already started, or the options are invalid.
+         */
+        void start(ReadPlanOptions options = {});
+
+        /**
+         * @brief Stops the scans; the polls in flight complete.
+         */
+        void stop();
+
+        /**
+         * @brief Returns the counters of every scan class, by increasing scan rate.
+         *
+         * Call it on the executor of the scheduler, or while the executor is not running.
+         */
+        std::vector<ScanClassStatistics> statistics() const;
+
+    private:
+        struct Device;
+        struct PollGroup;
+        struct ScanClass;
+        struct State;
+
+        // Shared with the scan and poll coroutines, which may still run after the scheduler is destroyed
+        std::shared_ptr<State> _state;
+
+        static boost::asio::awaitable<void> scan(std::shared_ptr<State> state, ScanClass &scanClass);
+
+        static boost::asio::awaitable<void> poll(std::shared_ptr<State> state, ScanClass &scanClass, PollGroup &group);
+    };
+}
+
+#endif //MBLIBRARY_MODBUSPOLLSCHEDULER_H
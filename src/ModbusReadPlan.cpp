@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include "ModbusReadPlan.h"
+#include "ModbusUtilities.h"
+
+namespace {
+    bool isBitTable(Modbus::TableType table) {
+        return table == Modbus::TableType::Coils || table == Modbus::TableType::DiscreteInputs;
+    }
+}
+
+Modbus::FunctionCode Modbus::ReadPlan::Request::functionCode() const {
+    switch (table) {
+        case TableType::Coils:
+            return FunctionCode::ReadCoils;
+        case TableType::DiscreteInputs:
+            return FunctionCode::ReadDiscreteInputs;
+        case TableType::HoldingRegisters:
+            return FunctionCode::ReadHoldingRegisters;
+        case TableType::InputRegisters:
+            return FunctionCode::ReadInputRegister;
+    }
+    throw std::invalid_argument("Unknown table type.");
+}
+
+Modbus::ReadPlan::ReadPlan(std::span<const ReadPoint> points, ReadPlanOptions options) : _pointCount(points.size()) {
+    if (options.maxRegisters == 0 || options.maxRegisters > ClientProtocol::MAX_READ_REGISTERS ||
+        options.maxBits == 0 || options.maxBits > ClientProtocol::MAX_READ_BITS)
+        throw std::invalid_argument("Invalid quantity limit for a read plan.");
+
+    std::vector<std::size_t> order(points.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&points](std::size_t a, std::size_t b) {
+        return std::tie(points[a].table, points[a].address) < std::tie(points[b].table, points[b].address);
+    });
+
+    _slots.reserve(points.size());
+    for (std::size_t i = 0; i < order.size();) {
+        const auto &first = points[order[i]];
+        bool bits = isBitTable(first.table);
+        int maxQuantity = bits ? options.maxBits : options.maxRegisters;
+        int maxGap = bits ? options.bitGap : options.registerGap;
+
+        _firstSlot.push_back(_slots.size());
+        int last = first.address;
+        for (; i < order.size(); ++i) {
+            const auto &point = points[order[i]];
+            if (point.table != first.table || point.address - last - 1 > maxGap ||
+                point.address - first.address >= maxQuantity)
+                break;
+            last = point.address;
+            _slots.push_back({order[i], static_cast<uint16_t>(point.address - first.address)});
+        }
+        _requests.push_back({first.table, first.address, static_cast<uint16_t>(last - first.address + 1)});
+    }
+    _firstSlot.push_back(_slots.size());
+}
+
+const std::vector<Modbus::ReadPlan::Request> &Modbus::ReadPlan::requests() const {
+    return _requests;
+}
+
+std::size_t Modbus::ReadPlan::pointCount() const {
+    return _pointCount;
+}
+
+void Modbus::ReadPlan::scatter(std::size_t request, std::span<const std::byte> response,
+                               std::span<uint16_t> values) const {
+    // The values follow the function code and the byte count
+    auto data = response.subspan(2);
+    bool bits = isBitTable(_requests[request].table);
+    for (auto slot = _firstSlot[request]; slot < _firstSlot[request + 1]; ++slot) {
+        auto [point, offset] = _slots[slot];
+        if (bits)
+            values[point] = std::to_integer<uint16_t>(data[offset / 8] >> (offset % 8)) & 1U;
+        else
+            values[point] = Utilities::twoBytesToUint16(data[offset * 2], data[offset * 2 + 1]);
+    }
+}
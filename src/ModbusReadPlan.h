@@ -0,0 +1,117 @@
+#ifndef MBLIBRARY_MODBUSREADPLAN_H
+#define MBLIBRARY_MODBUSREADPLAN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Modbus.h"
+#include "ModbusClientProtocol.h"
+#include "ModbusDataArea.h"
+#include "ModbusDataTable.h"
+
+namespace Modbus {
+
+    /**
+     * @struct ReadPoint
+     * @brief One value read by a ReadPlan: a coil, discrete input, holding register or input register.
+     */
+    struct ReadPoint {
+        TableType table;
+        uint16_t address;
+    };
+
+    /**
+     * @struct ReadPlanOptions
+     * @brief How a ReadPlan coalesces its points into requests.
+     */
+    struct ReadPlanOptions {
+        /// The largest hole between two registers read by the same request. The registers of the hole are read and
+        /// discarded: bridging a small hole costs a few bytes, while a separate request costs a round trip.
+        uint16_t registerGap = 16;
+
+        /// The largest hole between two coils or discrete inputs read by the same request.
+        uint16_t bitGap = 128;
+
+        /// The most registers read by one request. The default is what this library's server accepts; it may be
+        /// raised up to the protocol limit, ClientProtocol::MAX_READ_REGISTERS, for devices that accept it, or
+        /// lowered for devices that accept less.
+        uint16_t maxRegisters = std::min(MAX_HOLDING_REGISTERS, MAX_INPUT_REGISTERS);
+
+        /// The most coils or discrete inputs read by one request, at most ClientProtocol::MAX_READ_BITS.
+        uint16_t maxBits = std::min(MAX_COILS, MAX_DISCRETE_INPUTS);
+    };
+
+    /**
+     * @class ReadPlan
+     * @brief The fewest read requests covering a list of scattered points, and where each point's value lands.
+     *
+     * The points are sorted by table and address and cut into requests greedily: a request grows until the next
+     * point is in another table, beyond the allowed hole, or beyond the quantity limit. Within those rules no plan
+     * uses fewer requests. The plan is built once and then executed on every poll by Client::read() or
+     * AsyncClient::read(), which scatter the values of the responses back to the points in their original order.
+     *
+     * @par Example
+     * @code{.cpp}
+     * std::vector<Modbus::ReadPoint> tags{{Modbus::TableType::HoldingRegisters, 1000},
+     *                                     {Modbus::TableType::HoldingRegisters, 1003},
+     *                                     {Modbus::TableType::Coils, 12}};
+     * Modbus::ReadPlan plan(tags);          // Two requests: registers 1000-1003 and coil 12
+     * auto values = client.read(plan);      // values[i] is the value of tags[i]
+     * @endcode
+     */
+    class ReadPlan {
+    public:
+        /**
+         * @struct Request
+         * @brief One read request of the plan.
+         */
+        struct Request {
+            TableType table;
+            uint16_t startAddress;
+            uint16_t quantity;
+
+            /**
+             * @brief Returns the function code reading the table of the request.
+             */
+            FunctionCode functionCode() const;
+        };
+
+        /**
+         * @param points The points to read; a point may be listed several times.
+         * @param options The hole tolerance and quantity limits.
+         * @throws std::invalid_argument if a quantity limit is 0 or above the protocol limit.
+         */
+        explicit ReadPlan(std::span<const ReadPoint> points, ReadPlanOptions options = {});
+
+        const std::vector<Request> &requests() const;
+
+        /**
+         * @brief Returns the number of points, which is the number of values read by the plan.
+         */
+        std::size_t pointCount() const;
+
+        /**
+         * @brief Copies the values of the points read by a request from its response.
+         *
+         * @param request The index of the request in requests().
+         * @param response The checked response PDU of the request.
+         * @param values The values of the points, pointCount() of them; coils and discrete inputs are 0 or 1.
+         */
+        void scatter(std::size_t request, std::span<const std::byte> response, std::span<uint16_t> values) const;
+
+    private:
+        struct Slot {
+            std::size_t point;
+            uint16_t offset; // From the start address of the request
+        };
+
+        std::vector<Request> _requests;
+        std::vector<Slot> _slots;            // Grouped by request
+        std::vector<std::size_t> _firstSlot; // The slots of request i are [_firstSlot[i], _firstSlot[i + 1])
+        std::size_t _pointCount;
+    };
+}
+
+#endif //MBLIBRARY_MODBUSREADPLAN_H
@@ -2,30 +2,139 @@
 // Created by ljohnson on 3/28/2024.
 //
 
+#include <algorithm>
 #include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 #include "ModbusServer.h"
 #include "ModbusPDU.h"
+#include "ModbusFrameAssembler.h"
 #include <iostream>
 
-Modbus::Server::MBServer::MBServer(Modbus::DataArea &dataArea) : _modbusDataArea(dataArea) {
+namespace {
+    bool isWriteFunction(Modbus::FunctionCode functionCode) {
+        return functionCode == Modbus::FunctionCode::WriteSingleCoil ||
+               functionCode == Modbus::FunctionCode::WriteSingleRegister ||
+               functionCode == Modbus::FunctionCode::WriteMultipleCoils ||
+               functionCode == Modbus::FunctionCode::WriteMultipleRegisters;
+    }
+
+#ifdef SO_REUSEPORT
+    using ReusePort = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+}
+
+Modbus::Server::MBServer::MBServer(Modbus::DataArea &dataArea, ServerOptions options)
+        : MBServer(UnitMap(dataArea), std::move(options)) {
+}
+
+Modbus::Server::MBServer::MBServer(UnitMap units, ServerOptions options)
+        : _options(std::move(options)), _units(std::move(units)) {
+    if (_options.endpoints.empty())
+        throw std::invalid_argument("At least one endpoint is required");
+    if (_options.backlog <= 0)
+        throw std::invalid_argument("The backlog must be positive");
+    if (_options.receiveBufferSize < 0 || _options.sendBufferSize < 0)
+        throw std::invalid_argument("Buffer sizes cannot be negative");
+#ifndef SO_REUSEPORT
+    if (_options.acceptMode == AcceptMode::ReusePortPerWorker)
+        throw std::invalid_argument("SO_REUSEPORT is not supported on this platform");
+#endif
+    if (_options.workerThreads == 0)
+        _options.workerThreads = std::max(1U, std::thread::hardware_concurrency());
+
+    bool sharded = _options.acceptMode == AcceptMode::ReusePortPerWorker;
+    auto shardCount = sharded ? _options.workerThreads : 1U;
+    auto concurrencyHint = static_cast<int>(sharded ? 1U : _options.workerThreads);
+    auto endpoints = _options.endpoints;
+    for (unsigned int i = 0; i < shardCount; ++i) {
+        auto &shard = *_shards.emplace_back(std::make_unique<Shard>(concurrencyHint));
+        for (auto &endpoint: endpoints) {
+            openAcceptor(shard.acceptors.emplace_back(shard.ioContext), endpoint);
+            // Later shards must share the port the first one got for an ephemeral endpoint
+            endpoint = shard.acceptors.back().local_endpoint();
+        }
+    }
+}
+
+void Modbus::Server::MBServer::openAcceptor(tcp::acceptor &acceptor, const tcp::endpoint &endpoint) const {
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(tcp::acceptor::reuse_address(true));
+    if (endpoint.address().is_v6())
+        acceptor.set_option(boost::asio::ip::v6_only(true));
+#ifdef SO_REUSEPORT
+    if (_options.acceptMode == AcceptMode::ReusePortPerWorker)
+        acceptor.set_option(ReusePort(true));
+#endif
+    // Accepted sockets inherit the buffer sizes of the listening socket; setting them before listen() lets the
+    // TCP window scale be negotiated for them during the handshake
+    if (_options.receiveBufferSize > 0)
+        acceptor.set_option(boost::asio::socket_base::receive_buffer_size(_options.receiveBufferSize));
+    if (_options.sendBufferSize > 0)
+        acceptor.set_option(boost::asio::socket_base::send_buffer_size(_options.sendBufferSize));
+    acceptor.bind(endpoint);
+    acceptor.listen(_options.backlog);
 }
 
 void Modbus::Server::MBServer::start() {
-    boost::asio::co_spawn(_acceptor.get_executor(), [this]() { return listener(); },
-                          boost::asio::detached);
-    _ioContext.run();
+    for (auto &shard: _shards) {
+        for (auto &acceptor: shard->acceptors)
+            boost::asio::co_spawn(shard->ioContext,
+                                  [this, &shard, &acceptor]() { return listener(*shard, acceptor); },
+                                  boost::asio::detached);
+    }
+
+    // Worker i runs shard i % shardCount: every worker shares the single shard, or each owns its own
+    std::vector<std::thread> workers;
+    workers.reserve(_options.workerThreads - 1);
+    for (unsigned int i = 1; i < _options.workerThreads; ++i)
+        workers.emplace_back([this, &shard = *_shards[i % _shards.size()]]() { shard.ioContext.run(); });
+    _shards.front()->ioContext.run();
+    for (auto &worker: workers)
+        worker.join();
+    for (auto &shard: _shards) {
+        for (auto &acceptor: shard->acceptors)
+            acceptor.close();
+    }
 }
 
 void Modbus::Server::MBServer::stop() {
-    _acceptor.close();
-    _ioContext.stop();
+    // The acceptors are closed by start() once the workers are done, since it is not safe to close them from
+    // a thread other than the ones running their io_context.
+    for (auto &shard: _shards)
+        shard->ioContext.stop();
 }
 
-boost::asio::awaitable<void> Modbus::Server::MBServer::listener() {
+unsigned int Modbus::Server::MBServer::workerThreads() const {
+    return _options.workerThreads;
+}
+
+Modbus::Server::AcceptMode Modbus::Server::MBServer::acceptMode() const {
+    return _options.acceptMode;
+}
+
+std::vector<tcp::endpoint> Modbus::Server::MBServer::localEndpoints() const {
+    std::vector<tcp::endpoint> endpoints;
+    for (const auto &acceptor: _shards.front()->acceptors)
+        endpoints.push_back(acceptor.local_endpoint());
+    return endpoints;
+}
+
+boost::asio::awaitable<void> Modbus::Server::MBServer::listener(Shard &shard, tcp::acceptor &acceptor) {
     for (;;) {
-        tcp::socket socket = co_await _acceptor.async_accept(boost::asio::use_awaitable);
-        boost::asio::co_spawn(_acceptor.get_executor(),
+        // Each connection gets its own strand, so its handlers are serialized while connections run in parallel
+        tcp::socket socket = co_await acceptor.async_accept(boost::asio::make_strand(shard.ioContext),
+                                                            boost::asio::use_awaitable);
+        // Responses are small and written one per request; Nagle would hold back every pipelined response
+        // after the first until the client acknowledges it. A connection reset since it was accepted makes these
+        // fail; the session then fails on its first read, while a throw would end the accept loop.
+        boost::system::error_code ignored;
+        socket.set_option(tcp::no_delay(_options.noDelay), ignored);
+        socket.set_option(boost::asio::socket_base::keep_alive(_options.keepAlive), ignored);
+        auto executor = socket.get_executor();
+        boost::asio::co_spawn(executor,
                               [this, socket = std::move(socket)]() mutable { return session(std::move(socket)); },
                               boost::asio::detached);
     }
@@ -33,8 +142,10 @@ boost::asio::awaitable<void> Modbus::Server::MBServer::listener() {
 
 boost::asio::awaitable<void> Modbus::Server::MBServer::session(tcp::socket socket) {
     try {
+        // Per-connection buffers, reused for every request of the session
+        Modbus::FrameAssembler assembler;
+        std::array<std::byte, Modbus::MAX_ADU_LENGTH> frame{};
         for (;;) {
-            std::array<std::byte, 1024> data{};
             // Read data from the socket
             if (!socket.is_open()) {
                 std::cerr << "Socket is closed" << std::endl;
@@ -43,42 +154,61 @@ boost::asio::awaitable<void> Modbus::Server::MBServer::session(tcp::socket socke
             // Execute the async_read_some operation and handle possible exceptions
             std::size_t receivedBytes = 0;
             try {
-                receivedBytes = co_await socket.async_read_some(boost::asio::buffer(data), boost::asio::use_awaitable);
+                auto space = assembler.prepare();
+                receivedBytes = co_await socket.async_read_some(boost::asio::buffer(space.data(), space.size()),
+                                                                boost::asio::use_awaitable);
             } catch (const boost::system::system_error &e) {
                 std::cerr << "Error on async_read_some: " << e.what() << std::endl;
                 break;
             }
+            assembler.commit(receivedBytes);
 
-            std::vector<std::byte> bytes(receivedBytes);
-            std::copy(data.begin(), data.begin() + receivedBytes, bytes.begin());
-            auto response = co_await createResponse(bytes);
+            // Answer every complete request of the read before reading again; pipelined requests may arrive
+            // together, and a partial request stays in the assembler until the rest of it is received.
+            while (auto request = assembler.nextFrame()) {
+                auto responseSize = createResponse(*request, frame);
+                if (responseSize == 0)
+                    continue;
 
-            // Create a buffer from the response vector
-            auto responseBuffer = boost::asio::buffer(response, response.size());
+                // Create a buffer from the response frame
+                auto responseBuffer = boost::asio::buffer(frame, responseSize);
 
-            // Execute the async_write operation and handle possible exceptions
-            try {
-                // Write the response to the socket
+                // Execute the async_write operation; errors end the session
                 co_await boost::asio::async_write(socket, responseBuffer, boost::asio::use_awaitable);
-            } catch (const boost::system::system_error &e) {
-                std::cerr << "Error on async_write: " << e.what() << std::endl;
-                break;
             }
-
         }
     } catch (std::exception &e) {
         std::cerr << "Error: " << e.what() << std::endl;
     }
 }
 
-boost::asio::awaitable<std::vector<std::byte>> Modbus::Server::MBServer::createResponse(std::vector<std::byte> &bytes) {
+std::size_t Modbus::Server::MBServer::createResponse(std::span<const std::byte> bytes, std::span<std::byte> frame) {
     auto requestMbpa = Modbus::bytesToMBAP(bytes);
-    auto bytesForPDU = std::vector<std::byte>(bytes.begin() + Modbus::Server::MBAP_HEADER_LENGTH, bytes.end());
-    Modbus::PDU pdu(bytesForPDU, _modbusDataArea);
-    auto responsePdu = pdu.buildResponse();
+    auto requestPdu = bytes.subspan(Modbus::MBAP_HEADER_LENGTH);
+    auto responsePdu = frame.subspan(Modbus::MBAP_HEADER_LENGTH);
+    if (requestMbpa.unitIdentifier == UnitMap::BROADCAST_UNIT && _units.broadcast()) {
+        // Broadcast writes reach every device and, as on a serial line, no device answers a broadcast
+        if (isWriteFunction(Modbus::byteToModbusFunctionCode(requestPdu[0]))) {
+            for (auto *dataArea: _units.dataAreas()) {
+                Modbus::PDU pdu(requestPdu, *dataArea);
+                pdu.buildResponse(responsePdu);
+            }
+        }
+        return 0;
+    }
+
+    std::size_t responsePduSize = 0;
+    if (auto *dataArea = _units.find(requestMbpa.unitIdentifier)) {
+        Modbus::PDU pdu(requestPdu, *dataArea);
+        responsePduSize = pdu.buildResponse(responsePdu);
+    } else if (auto exceptionCode = _units.unknownUnitException()) {
+        responsePduSize = Modbus::buildExceptionResponse(Modbus::byteToModbusFunctionCode(requestPdu[0]),
+                                                         *exceptionCode, responsePdu);
+    } else {
+        return 0;
+    }
     auto responseMbpa = Modbus::MBAP{requestMbpa.transactionIdentifier, requestMbpa.protocolIdentifier,
-                                     static_cast<uint16_t>(responsePdu.size() + 1), requestMbpa.unitIdentifier};
-    auto response = Modbus::MBAPToBytes(responseMbpa);
-    response.insert(response.end(), responsePdu.begin(), responsePdu.end());
-    co_return response;
+                                     static_cast<uint16_t>(responsePduSize + 1), requestMbpa.unitIdentifier};
+    Modbus::writeMBAP(responseMbpa, frame);
+    return Modbus::MBAP_HEADER_LENGTH + responsePduSize;
 }
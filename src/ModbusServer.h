@@ -5,16 +5,20 @@
 #ifndef MBLIBRARY_MODBUSSERVER_H
 #define MBLIBRARY_MODBUSSERVER_H
 
+#include <memory>
+#include <thread>
+#include <vector>
 #include <boost/asio.hpp>
 #include "Modbus.h"
 #include "ModbusDataArea.h"
+#include "ModbusPDU.h"
+#include "ModbusUnitMap.h"
 
 using boost::asio::ip::tcp;
 
 
 namespace Modbus::Server {
 
-    const int MBAP_HEADER_LENGTH = 7; // Size of the Modbus Application Protocol header
     /**
      * @brief Starts a listener using Boost.Asio.
      *
@@ -41,16 +45,95 @@ namespace Modbus::Server {
      */
     boost::asio::awaitable<void> read_data(tcp::socket socket);
 
+    /**
+     * @enum AcceptMode
+     * @brief How an MBServer distributes incoming connections across its worker threads.
+     */
+    enum class AcceptMode {
+        /// One acceptor on an io_context shared by every worker; each connection runs on its own strand.
+        SharedAcceptor,
+        /// Every worker owns an io_context and an acceptor bound with SO_REUSEPORT. The kernel balances the
+        /// accepts across the workers and a connection never leaves the worker that accepted it.
+        ReusePortPerWorker
+    };
+
+    /**
+     * @struct ServerOptions
+     * @brief The configuration an MBServer is created with.
+     *
+     * The defaults reproduce a plain Modbus/TCP server: every IPv4 interface on port 502, one worker thread per
+     * hardware thread and a shared acceptor.
+     */
+    struct ServerOptions {
+        /// The endpoints to listen on. IPv6 endpoints are bound IPv6-only, so an IPv4 and an IPv6 endpoint may
+        /// share a port. Port 0 binds an ephemeral port, see MBServer::localEndpoints().
+        std::vector<tcp::endpoint> endpoints{tcp::endpoint(tcp::v4(), 502)};
+
+        /// The maximum length of the queue of pending connections of each acceptor.
+        int backlog = boost::asio::socket_base::max_listen_connections;
+
+        /// Disables Nagle's algorithm on accepted connections (TCP_NODELAY).
+        bool noDelay = true;
+
+        /// Enables TCP keepalive probes on accepted connections (SO_KEEPALIVE).
+        bool keepAlive = false;
+
+        /// The receive buffer size of accepted connections (SO_RCVBUF); 0 keeps the system default.
+        int receiveBufferSize = 0;
+
+        /// The send buffer size of accepted connections (SO_SNDBUF); 0 keeps the system default.
+        int sendBufferSize = 0;
+
+        /// The number of threads serving requests; 0 uses std::thread::hardware_concurrency().
+        unsigned int workerThreads = 0;
+
+        /// How the incoming connections are distributed across the worker threads.
+        AcceptMode acceptMode = AcceptMode::SharedAcceptor;
+    };
+
     /**
      * @class MBServer
      * @brief Represents a server that listens for incoming Modbus requests
      *
      * The MBServer class provides methods to start and stop the server,
      * as well as handling incoming connections and processing Modbus requests.
+     *
+     * The unit identifier of every request selects the DataArea it operates on through a UnitMap, so a single
+     * server, listener and thread pool can emulate a gateway fronting many devices.
+     *
+     * Requests are served by a pool of worker threads sharing one io_context. Each connection runs on its own
+     * strand, so the handlers of a connection never run concurrently while different connections are served in
+     * parallel. The DataArea synchronizes its own access, so it can be shared by all the workers.
+     *
+     * With AcceptMode::ReusePortPerWorker the workers are sharded instead: each one runs its own io_context and
+     * accepts its own connections, which suits many short-lived connections where a single listener would be the
+     * bottleneck.
      */
     class MBServer {
     public:
-        explicit MBServer(Modbus::DataArea &dataArea);
+        /**
+         * @brief Creates a server serving the given data area, whatever the unit identifier, and binds its endpoints.
+         *
+         * The endpoints are bound and listening once the constructor returns, so clients may connect before
+         * start() is called.
+         *
+         * @param dataArea The data area the requests operate on.
+         * @param options The endpoints, socket options and threading of the server.
+         * @throws std::invalid_argument if the options have no endpoint, a non-positive backlog or a negative
+         * buffer size, or if they ask for AcceptMode::ReusePortPerWorker on a platform without SO_REUSEPORT.
+         * @throws boost::system::system_error if an endpoint cannot be bound.
+         */
+        explicit MBServer(Modbus::DataArea &dataArea, ServerOptions options = {});
+
+        /**
+         * @brief Creates a server routing the requests to data areas by unit identifier and binds its endpoints.
+         *
+         * @param units The data area of every unit, and how requests for other units and broadcasts are handled.
+         * @param options The endpoints, socket options and threading of the server.
+         * @throws std::invalid_argument if the options are invalid, see MBServer(DataArea &, ServerOptions).
+         * @throws boost::system::system_error if an endpoint cannot be bound.
+         */
+        explicit MBServer(UnitMap units, ServerOptions options = {});
 
         /**
          * @fn void start()
@@ -59,6 +142,9 @@ namespace Modbus::Server {
          * This function starts the server by initializing the acceptor and binding it to a specific port.
          * It then enters an infinite loop, continuously accepting incoming connections and spawning sessions for each connection.
          * The acceptor is configured to use the provided DataArea object to process the Modbus requests.
+         *
+         * The calling thread becomes one of the worker threads; the others are started here. The function
+         * returns once the server is stopped and every worker thread has finished.
          */
         void start();
 
@@ -66,43 +152,84 @@ namespace Modbus::Server {
          * @fn void stop()
          * @brief Stops the Modbus server.
          *
-         * This function closes the acceptor, stopping the server from listening for incoming connections.
+         * This function stops the worker threads, ending every session, and closes the acceptor, stopping the
+         * server from listening for incoming connections. It can be called from any thread.
          */
         void stop();
 
+        /**
+         * @brief Returns the number of threads serving requests.
+         */
+        unsigned int workerThreads() const;
+
+        /**
+         * @brief Returns how the incoming connections are distributed across the worker threads.
+         */
+        AcceptMode acceptMode() const;
+
+        /**
+         * @brief Returns the endpoints the server is bound to, in the order of ServerOptions::endpoints.
+         *
+         * Unlike the configured endpoints, these carry the actual port of endpoints configured with port 0.
+         */
+        std::vector<tcp::endpoint> localEndpoints() const;
+
 
     private:
-        boost::asio::io_context _ioContext;
+        /**
+         * @struct Shard
+         * @brief An io_context together with the acceptors, one per endpoint, whose connections it serves.
+         */
+        struct Shard {
+            explicit Shard(int concurrencyHint) : ioContext(concurrencyHint) {}
+
+            boost::asio::io_context ioContext;
+            std::vector<tcp::acceptor> acceptors;
+        };
 
-        short _port = 502;
+        ServerOptions _options;
 
-        tcp::acceptor _acceptor{_ioContext, tcp::endpoint(tcp::v4(), _port)};
+        UnitMap _units;
 
-        Modbus::DataArea &_modbusDataArea;
+        /// A single shard run by every worker, or one shard per worker with AcceptMode::ReusePortPerWorker
+        std::vector<std::unique_ptr<Shard>> _shards;
 
         /**
          * @brief Creates a Modbus response for a given Modbus request.
          *
-         * This function takes a vector of bytes representing a Modbus request and creates a Modbus response.
-         * The function extracts the MBAP (Modbus Application Protocol) header from the request,
-         * builds a PDU (Protocol Data Unit) from the remaining bytes, and constructs the response MBAP header.
-         * Finally, the function combines the response MBAP header with the response PDU and returns the result as a vector of bytes.
+         * This function takes a view of the bytes of a Modbus request and writes the Modbus response into the
+         * connection's frame buffer. The function extracts the MBAP (Modbus Application Protocol) header from the
+         * request, builds the response PDU right after the header space of the frame, and then writes the response
+         * MBAP header in front of it.
          *
-         * @param bytes The vector containing the Modbus request bytes.
-         * @return A vector of bytes representing the Modbus response.
+         * The request is parsed in place and the response is built in place, so no heap allocation takes place.
+         *
+         * The unit identifier selects the data area through the unit map. Broadcasts, and requests for unknown
+         * units when the map leaves them unanswered, produce no response.
+         *
+         * @param bytes A view of the Modbus request bytes in the receive buffer.
+         * @param frame The connection's response frame buffer, at least MAX_ADU_LENGTH bytes.
+         * @return The number of bytes of the response frame, or 0 if the request must not be answered.
          */
-        boost::asio::awaitable<std::vector<std::byte>> createResponse(std::vector<std::byte> &bytes);
+        std::size_t createResponse(std::span<const std::byte> bytes, std::span<std::byte> frame);
 
         /**
-             * @fn boost::asio::awaitable<void> listener()
+             * @fn boost::asio::awaitable<void> listener(Shard &shard, tcp::acceptor &acceptor)
              * @brief Listens for incoming connections and spawns sessions for each connection.
              *
              * This function is responsible for listening for incoming connections and spawning sessions for each connection.
              * It is implemented using Boost.Asio's coroutines for asynchronous I/O operations.
              *
+             * @param shard The shard owning the acceptor; the sessions run on its io_context.
+             * @param acceptor The acceptor to listen on.
              * @return A Boost.Asio awaitable object that represents the asynchronous listener operation.
              */
-        boost::asio::awaitable<void> listener();
+        boost::asio::awaitable<void> listener(Shard &shard, tcp::acceptor &acceptor);
+
+        /**
+         * @brief Opens, configures and binds an acceptor for the given endpoint and starts listening.
+         */
+        void openAcceptor(tcp::acceptor &acceptor, const tcp::endpoint &endpoint) const;
 
         /**
         * @fn boost::asio::awaitable<void> session(tcp::socket socket)
@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "ModbusUnitMap.h"
+
+Modbus::Server::UnitMap::UnitMap(DataArea &defaultDataArea) {
+    setDefault(defaultDataArea);
+}
+
+void Modbus::Server::UnitMap::add(uint8_t unitIdentifier, DataArea &dataArea) {
+    if (_units[unitIdentifier] != nullptr)
+        throw std::invalid_argument("Unit " + std::to_string(unitIdentifier) + " already has a data area.");
+    if (unitIdentifier == BROADCAST_UNIT && _broadcast)
+        throw std::invalid_argument("Unit 0 is the broadcast unit while broadcast is enabled.");
+    _units[unitIdentifier] = &dataArea;
+    remember(dataArea);
+}
+
+void Modbus::Server::UnitMap::setDefault(DataArea &dataArea) {
+    auto *previous = std::exchange(_default, &dataArea);
+    // The replaced default no longer receives broadcasts, unless it still serves a unit of its own
+    if (previous != nullptr && previous != &dataArea &&
+        std::find(_units.begin(), _units.end(), previous) == _units.end())
+        std::erase(_dataAreas, previous);
+    remember(dataArea);
+}
+
+void Modbus::Server::UnitMap::setBroadcast(bool enabled) {
+    if (enabled && _units[BROADCAST_UNIT] != nullptr)
+        throw std::invalid_argument("Unit 0 has its own data area and cannot be the broadcast unit.");
+    _broadcast = enabled;
+}
+
+void Modbus::Server::UnitMap::setUnknownUnitException(std::optional<ExceptionCode> exceptionCode) {
+    _unknownUnitException = exceptionCode;
+}
+
+bool Modbus::Server::UnitMap::broadcast() const {
+    return _broadcast;
+}
+
+std::optional<Modbus::ExceptionCode> Modbus::Server::UnitMap::unknownUnitException() const {
+    return _unknownUnitException;
+}
+
+const std::vector<Modbus::DataArea *> &Modbus::Server::UnitMap::dataAreas() const {
+    return _dataAreas;
+}
+
+void Modbus::Server::UnitMap::remember(DataArea &dataArea) {
+    // A data area serving several units receives a broadcast once
+    if (std::find(_dataAreas.begin(), _dataAreas.end(), &dataArea) == _dataAreas.end())
+        _dataAreas.push_back(&dataArea);
+}
@@ -0,0 +1,105 @@
+#ifndef MBLIBRARY_MODBUSUNITMAP_H
+#define MBLIBRARY_MODBUSUNITMAP_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Modbus.h"
+#include "ModbusDataArea.h"
+
+namespace Modbus::Server {
+
+    /**
+     * @class UnitMap
+     * @brief Routes the unit identifier of Modbus/TCP requests to the data area of the device addressed.
+     *
+     * A server given a UnitMap emulates a gateway fronting several devices: every unit identifier may have its own
+     * DataArea, and units without one are served by the default data area if there is one. Requests for a unit that
+     * has neither are answered with an exception, GatewayPathUnavailable unless configured otherwise.
+     *
+     * When broadcast is enabled, unit identifier 0 addresses every device at once as on a serial line: write
+     * requests are applied to every data area of the map and no request to unit 0 is answered.
+     *
+     * The data areas are referenced, not owned, and must outlive the servers using the map. Lookups are a single
+     * array access.
+     */
+    class UnitMap {
+    public:
+        static constexpr uint8_t BROADCAST_UNIT = 0;
+
+        /**
+         * @brief Creates an empty map; every request is answered with the unknown unit exception.
+         */
+        UnitMap() = default;
+
+        /**
+         * @brief Creates a map serving every unit from a single data area.
+         */
+        explicit UnitMap(DataArea &defaultDataArea);
+
+        /**
+         * @brief Routes the requests for a unit to a data area.
+         *
+         * @throws std::invalid_argument if the unit already has a data area, or if it is the broadcast unit while
+         * broadcast is enabled.
+         */
+        void add(uint8_t unitIdentifier, DataArea &dataArea);
+
+        /**
+         * @brief Sets the data area serving the units that have none of their own.
+         *
+         * The data area it replaces is dropped from dataAreas(), and so from broadcasts, unless it is also the data
+         * area of a unit.
+         */
+        void setDefault(DataArea &dataArea);
+
+        /**
+         * @brief Enables or disables broadcast requests to unit 0.
+         *
+         * @throws std::invalid_argument if broadcast is enabled while unit 0 has its own data area.
+         */
+        void setBroadcast(bool enabled);
+
+        /**
+         * @brief Sets the exception answering requests for units without a data area.
+         *
+         * @param exceptionCode The exception code, or std::nullopt to leave such requests unanswered, as a missing
+         * device would.
+         */
+        void setUnknownUnitException(std::optional<ExceptionCode> exceptionCode);
+
+        /**
+         * @brief Returns the data area serving a unit: its own, the default one, or nullptr if there is none.
+         */
+        DataArea *find(uint8_t unitIdentifier) const {
+            return _units[unitIdentifier] != nullptr ? _units[unitIdentifier] : _default;
+        }
+
+        /**
+         * @brief Checks whether requests to BROADCAST_UNIT are broadcast to every data area.
+         */
+        bool broadcast() const;
+
+        /**
+         * @brief Returns the exception answering requests for units without a data area, if they are answered.
+         */
+        std::optional<ExceptionCode> unknownUnitException() const;
+
+        /**
+         * @brief Returns every distinct data area of the map, including the default one.
+         */
+        const std::vector<DataArea *> &dataAreas() const;
+
+    private:
+        std::array<DataArea *, 256> _units{};
+        DataArea *_default = nullptr;
+        std::vector<DataArea *> _dataAreas;
+        bool _broadcast = false;
+        std::optional<ExceptionCode> _unknownUnitException = ExceptionCode::GatewayPathUnavailable;
+
+        void remember(DataArea &dataArea);
+    };
+}
+
+#endif //MBLIBRARY_MODBUSUNITMAP_H
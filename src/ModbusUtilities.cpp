@@ -1,18 +1,23 @@
 #include "ModbusUtilities.h"
 
 namespace Modbus::Utilities {
+    namespace {
+        // Seeding a Mersenne Twister from std::random_device is far more expensive than drawing from it,
+        // so each thread seeds its engine once and reuses it.
+        std::mt19937 &randomEngine() {
+            thread_local std::mt19937 gen(std::random_device{}());
+            return gen;
+        }
+    }
+
     bool generateRandomBoolean() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
         std::uniform_int_distribution<> distribution(0, 1);
-        return distribution(gen);
+        return distribution(randomEngine());
     }
 
     int generateRandomInteger(int min, int max) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
         std::uniform_int_distribution<> distribution(min, max);
-        return distribution(gen);
+        return distribution(randomEngine());
     }
 
     uint16_t twoBytesToUint16(std::byte msb, std::byte lsb) {
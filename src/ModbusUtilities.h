@@ -51,7 +51,7 @@ namespace Modbus::Utilities {
      *
      * This function uses the C++ random number generation library to generate
      * a random boolean value. It initializes a random number generator using
-     * std::random_device as a seed and std::mt19937 as the generator engine.
+     * std::random_device as a seed (once per thread) and std::mt19937 as the generator engine.
      * It then creates a uniform integer distribution with a range of 0 to 1.
      * The function returns true if the randomly generated value is 1, and false
      * if the value is 0.
@@ -73,7 +73,7 @@ namespace Modbus::Utilities {
          *
          * @return A random integer within the specified range [min, max].
          *
-         * @note The random seed is generated using std::random_device.
+         * @note The random seed is generated once per thread using std::random_device.
          *       The Mersenne Twister algorithm (std::mt19937) is used to generate the random value.
          *       The random value is generated using std::uniform_int_distribution.
          *
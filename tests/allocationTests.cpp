@@ -0,0 +1,96 @@
+//
+// Tests asserting that the request hot path does not touch the heap. The global allocation functions are replaced
+// in this executable so that every heap allocation can be counted.
+//
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <ModbusDataArea.h>
+#include <ModbusPDU.h>
+
+namespace {
+    std::atomic<std::size_t> allocationCount{0};
+}
+
+void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+class AllocationTest : public ::testing::Test {
+protected:
+    Modbus::DataArea dataArea;
+
+    // Read Holding Registers request ADU: MBAP header followed by the PDU
+    std::array<std::byte, 12> receiveBuffer{
+            std::byte{0x00}, std::byte{0x2A}, // Transaction Identifier = 42
+            std::byte{0x00}, std::byte{0x00}, // Protocol Identifier = 0
+            std::byte{0x00}, std::byte{0x06}, // Length = 6
+            std::byte{0x01},                  // Unit Identifier = 1
+            std::byte{0x03},                  // Function code: Read Holding Registers (3)
+            std::byte{0x00}, std::byte{0x00}, // Starting address = 0
+            std::byte{0x00}, std::byte{0x0A}  // Quantity = 10
+    };
+
+    void SetUp() override {
+        dataArea.generateHoldingRegisters(0, 10, Modbus::ValueGenerationType::Incremental);
+    }
+};
+
+TEST_F(AllocationTest, ParsingReadHoldingRegistersRequestDoesNotAllocate) {
+    std::span<const std::byte> request(receiveBuffer);
+
+    auto allocationsBefore = allocationCount.load();
+    auto mbap = Modbus::bytesToMBAP(request);
+    Modbus::PDU pdu(request.subspan(7), dataArea);
+    auto functionCode = pdu.getFunctionCode();
+    auto allocationsAfter = allocationCount.load();
+
+    ASSERT_EQ(allocationsAfter - allocationsBefore, 0);
+    ASSERT_EQ(mbap.transactionIdentifier, 42);
+    ASSERT_EQ(functionCode, Modbus::FunctionCode::ReadHoldingRegisters);
+
+    auto response = pdu.buildResponse();
+    ASSERT_EQ(response.size(), 22);
+    ASSERT_EQ(response[5], std::byte{0x01}); // Second register LSB, value = 1
+}
+
+TEST_F(AllocationTest, ReadHoldingRegistersRoundTripIntoFrameBufferDoesNotAllocate) {
+    std::span<const std::byte> request(receiveBuffer);
+    std::array<std::byte, Modbus::MAX_ADU_LENGTH> frame{};
+
+    auto allocationsBefore = allocationCount.load();
+    auto mbap = Modbus::bytesToMBAP(request);
+    Modbus::PDU pdu(request.subspan(Modbus::MBAP_HEADER_LENGTH), dataArea);
+    auto pduSize = pdu.buildResponse(std::span(frame).subspan(Modbus::MBAP_HEADER_LENGTH));
+    mbap.length = static_cast<uint16_t>(pduSize + 1);
+    auto frameSize = Modbus::writeMBAP(mbap, frame) + pduSize;
+    auto allocationsAfter = allocationCount.load();
+
+    ASSERT_EQ(allocationsAfter - allocationsBefore, 0);
+    ASSERT_EQ(frameSize, 29);
+    ASSERT_EQ(frame[1], std::byte{0x2A}); // Transaction Identifier LSB
+    ASSERT_EQ(frame[5], std::byte{23}); // Length LSB: unit identifier + 22 bytes of PDU
+    ASSERT_EQ(frame[7], std::byte{0x03}); // Function code
+    ASSERT_EQ(frame[8], std::byte{20}); // Byte count
+    ASSERT_EQ(frame[28], std::byte{0x09}); // Last register LSB, value = 9
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
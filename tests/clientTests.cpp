@@ -0,0 +1,423 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <ModbusAsyncClient.h>
+#include <ModbusClient.h>
+#include <ModbusDataArea.h>
+#include <ModbusServer.h>
+
+using boost::asio::ip::tcp;
+
+class ClientTest : public ::testing::Test {
+protected:
+    Modbus::DataArea dataArea;
+    std::unique_ptr<Modbus::Server::MBServer> server;
+    std::thread serverThread;
+
+    void SetUp() override {
+        dataArea.generateCoils(0, 100, Modbus::ValueGenerationType::Zeros);
+        dataArea.generateDiscreteInputs(0, 100, Modbus::ValueGenerationType::Ones);
+        dataArea.generateHoldingRegisters(0, 200, Modbus::ValueGenerationType::Incremental);
+        dataArea.generateInputRegisters(0, 100, Modbus::ValueGenerationType::Zeros);
+
+        Modbus::Server::ServerOptions options;
+        options.endpoints = {tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)};
+        options.workerThreads = 1;
+        server = std::make_unique<Modbus::Server::MBServer>(dataArea, options);
+        serverThread = std::thread([this]() { server->start(); });
+    }
+
+    void TearDown() override {
+        server->stop();
+        serverThread.join();
+    }
+
+    uint16_t holdingRegister(int address) {
+        std::array<uint16_t, 1> value{};
+        dataArea.readHoldingRegisters(address, value);
+        return value[0];
+    }
+};
+
+TEST_F(ClientTest, ReadsEveryTable) {
+    Modbus::Client client("127.0.0.1", server->localEndpoints().front().port());
+    client.connect();
+
+    ASSERT_EQ(client.readCoils(0, 10), std::vector<bool>(10, false));
+    ASSERT_EQ(client.readDiscreteInputs(5, 11), std::vector<bool>(11, true));
+    std::array<uint16_t, 3> expected{};
+    dataArea.readHoldingRegisters(197, expected);
+    ASSERT_EQ(client.readHoldingRegisters(197, 3), std::vector<uint16_t>(expected.begin(), expected.end()));
+    ASSERT_EQ(client.readInputRegisters(0, 2), std::vector<uint16_t>(2, 0));
+}
+
+TEST_F(ClientTest, WritesReachTheDataArea) {
+    Modbus::Client client("127.0.0.1", server->localEndpoints().front().port());
+    client.connect();
+
+    client.writeSingleCoil(3, true);
+    client.writeSingleRegister(10, 0xBEEF);
+    client.writeMultipleCoils(20, 10, {true, false, true, true, false, false, false, false, true, true});
+    client.writeMultipleRegisters(100, 3, {7, 8, 9});
+
+    ASSERT_TRUE(dataArea.getCoils(3, 1)[0].read());
+    ASSERT_EQ(client.readCoils(20, 10),
+              (std::vector<bool>{true, false, true, true, false, false, false, false, true, true}));
+    ASSERT_EQ(client.readHoldingRegisters(10, 1), std::vector<uint16_t>{0xBEEF});
+    ASSERT_EQ(client.readHoldingRegisters(100, 3), (std::vector<uint16_t>{7, 8, 9}));
+}
+
+TEST_F(ClientTest, ExceptionResponseIsReportedWithItsCode) {
+    Modbus::Client client("127.0.0.1", server->localEndpoints().front().port());
+    client.connect();
+
+    try {
+        client.readHoldingRegisters(199, 5);
+        FAIL() << "Expected an exception response";
+    } catch (const Modbus::ExceptionResponseError &e) {
+        ASSERT_EQ(e.functionCode(), Modbus::FunctionCode::ReadHoldingRegisters);
+        ASSERT_EQ(e.exceptionCode(), Modbus::ExceptionCode::IllegalDataAddress);
+    }
+    // The connection stays usable after an exception response
+    ASSERT_EQ(client.readInputRegisters(0, 1).size(), 1);
+}
+
+TEST_F(ClientTest, RequestsThatDoNotFitInAFrameAreRejectedBeforeSending) {
+    Modbus::Client client("127.0.0.1", server->localEndpoints().front().port());
+    client.connect();
+
+    ASSERT_THROW(client.readCoils(0, 2001), std::invalid_argument);
+    ASSERT_THROW(client.readHoldingRegisters(0, 0), std::invalid_argument);
+    ASSERT_THROW(client.writeMultipleRegisters(0, 3, {1, 2}), std::invalid_argument);
+    ASSERT_EQ(client.readCoils(0, 1).size(), 1);
+}
+
+TEST_F(ClientTest, PipelinedRequestsAreAnsweredByTheServer) {
+    constexpr int REQUESTS = 40;
+    boost::asio::io_context context;
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", server->localEndpoints().front().port(), 1,
+                               {.window = 8});
+    std::vector<uint16_t> values(REQUESTS);
+    int completed = 0;
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        co_await client.connect();
+        for (int i = 0; i < REQUESTS; ++i) {
+            boost::asio::co_spawn(context, [&, i]() -> boost::asio::awaitable<void> {
+                values[i] = (co_await client.readHoldingRegisters(i, 1))[0];
+                if (++completed == REQUESTS)
+                    client.disconnect();
+            }, boost::asio::detached);
+        }
+    }, boost::asio::detached);
+    context.run();
+
+    std::array<uint16_t, REQUESTS> expected{};
+    dataArea.readHoldingRegisters(0, expected);
+    ASSERT_EQ(completed, REQUESTS);
+    ASSERT_EQ(values, std::vector<uint16_t>(expected.begin(), expected.end()));
+}
+
+TEST_F(ClientTest, AsyncReadPlanFillsTheWindow) {
+    std::vector<Modbus::ReadPoint> points;
+    for (uint16_t address = 0; address < 200; address += 20)
+        points.push_back({Modbus::TableType::HoldingRegisters, address});
+    Modbus::ReadPlan plan(points, {.registerGap = 0});
+    ASSERT_EQ(plan.requests().size(), 10);
+
+    boost::asio::io_context context;
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", server->localEndpoints().front().port(), 1,
+                               {.window = 4});
+    std::vector<uint16_t> values;
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        co_await client.connect();
+        values = co_await client.read(plan);
+        client.disconnect();
+    }, boost::asio::detached);
+    context.run();
+
+    ASSERT_EQ(values.size(), points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+        ASSERT_EQ(values[i], holdingRegister(points[i].address));
+}
+
+TEST(ClientTransactionTest, LateResponsesAreSkippedByTransactionIdentifier) {
+    boost::asio::io_context context;
+    tcp::acceptor acceptor(context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    std::thread fakeServer([&acceptor]() {
+        auto socket = acceptor.accept();
+        std::array<std::byte, 12> request{};
+        boost::asio::read(socket, boost::asio::buffer(request));
+        // A stale response with another transaction identifier, then the response to the request
+        std::array<std::byte, 11> stale{std::byte{0x00}, std::byte{0x7F}, std::byte{0x00}, std::byte{0x00},
+                                        std::byte{0x00}, std::byte{0x05}, request[6], std::byte{0x03},
+                                        std::byte{0x02}, std::byte{0xDE}, std::byte{0xAD}};
+        std::array<std::byte, 11> response = stale;
+        response[0] = request[0];
+        response[1] = request[1];
+        response[9] = std::byte{0x12};
+        response[10] = std::byte{0x34};
+        boost::asio::write(socket, boost::asio::buffer(stale));
+        boost::asio::write(socket, boost::asio::buffer(response));
+    });
+
+    Modbus::Client client("127.0.0.1", acceptor.local_endpoint().port());
+    client.connect();
+    auto values = client.readHoldingRegisters(0, 1);
+    fakeServer.join();
+    ASSERT_EQ(values, std::vector<uint16_t>{0x1234});
+}
+
+TEST_F(ClientTest, ReadPlanReturnsTheValueOfEveryPoint) {
+    Modbus::Client client("127.0.0.1", server->localEndpoints().front().port());
+    client.connect();
+    dataArea.writeSingletCoil(40, true);
+
+    std::vector<Modbus::ReadPoint> points{{Modbus::TableType::HoldingRegisters, 150},
+                                          {Modbus::TableType::Coils, 40},
+                                          {Modbus::TableType::HoldingRegisters, 3},
+                                          {Modbus::TableType::DiscreteInputs, 99},
+                                          {Modbus::TableType::HoldingRegisters, 5}};
+    Modbus::ReadPlan plan(points);
+    ASSERT_EQ(plan.requests().size(), 4);
+
+    ASSERT_EQ(client.read(plan),
+              (std::vector<uint16_t>{holdingRegister(150), 1, holdingRegister(3), 1, holdingRegister(5)}));
+}
+
+TEST_F(ClientTest, DefaultReadPlanLimitsAreAnsweredByTheServer) {
+    Modbus::Client client("127.0.0.1", server->localEndpoints().front().port());
+    client.connect();
+
+    // Bridged into a single request, the points would read 125 registers, more than MBServer answers
+    std::vector<Modbus::ReadPoint> points{{Modbus::TableType::HoldingRegisters, 0},
+                                          {Modbus::TableType::HoldingRegisters, 124}};
+    Modbus::ReadPlan plan(points, {.registerGap = 200});
+    for (const auto &request: plan.requests())
+        ASSERT_LE(request.quantity, Modbus::MAX_HOLDING_REGISTERS);
+
+    ASSERT_EQ(client.read(plan), (std::vector<uint16_t>{holdingRegister(0), holdingRegister(124)}));
+}
+
+TEST_F(ClientTest, AsyncClientReadsAndWritesOnCallerExecutor) {
+    boost::asio::io_context context;
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", server->localEndpoints().front().port());
+    std::vector<uint16_t> registers;
+    std::vector<bool> coils;
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        std::vector<uint16_t> values{7, 8, 9};
+        co_await client.connect();
+        co_await client.writeMultipleRegisters(100, 3, values);
+        co_await client.writeSingleCoil(3, true);
+        registers = co_await client.readHoldingRegisters(100, 3);
+        coils = co_await client.readCoils(2, 2);
+        client.disconnect();
+    }, boost::asio::detached);
+    context.run();
+
+    ASSERT_EQ(registers, (std::vector<uint16_t>{7, 8, 9}));
+    ASSERT_EQ(coils, (std::vector<bool>{false, true}));
+}
+
+TEST_F(ClientTest, AsyncClientReportsExceptionResponsesFromTheAwait) {
+    boost::asio::io_context context;
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", server->localEndpoints().front().port());
+    std::exception_ptr failure;
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        co_await client.connect();
+        try {
+            co_await client.readHoldingRegisters(199, 5);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        client.disconnect();
+    }, boost::asio::detached);
+    context.run();
+
+    ASSERT_THROW(std::rethrow_exception(failure), Modbus::ExceptionResponseError);
+}
+
+TEST_F(ClientTest, ManyAsyncClientsShareOneThread) {
+    constexpr int CLIENTS = 50;
+    constexpr int POLLS = 20;
+    boost::asio::io_context context;
+    std::vector<std::unique_ptr<Modbus::AsyncClient>> clients;
+    int completed = 0;
+    for (int i = 0; i < CLIENTS; ++i) {
+        clients.push_back(std::make_unique<Modbus::AsyncClient>(context.get_executor(), "127.0.0.1",
+                                                                server->localEndpoints().front().port()));
+        boost::asio::co_spawn(context, [&completed, &client = *clients.back(), i]() -> boost::asio::awaitable<void> {
+            co_await client.connect();
+            for (int poll = 0; poll < POLLS; ++poll) {
+                auto values = co_await client.readHoldingRegisters(i, 1);
+                if (values.size() == 1)
+                    ++completed;
+            }
+            client.disconnect();
+        }, boost::asio::detached);
+    }
+    // Every connection is polled by the calling thread alone
+    context.run();
+
+    ASSERT_EQ(completed, CLIENTS * POLLS);
+}
+
+using ReadRequest = std::array<std::byte, 12>;
+
+/**
+ * @brief A fake server accepting one connection, for the tests that control the timing of the responses.
+ */
+class FakeServerTest : public ::testing::Test {
+protected:
+    boost::asio::io_context serverContext;
+    tcp::acceptor acceptor{serverContext, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)};
+    boost::asio::io_context context;
+
+    static uint16_t startAddressOf(const ReadRequest &request) {
+        return static_cast<uint16_t>((std::to_integer<int>(request[8]) << 8) | std::to_integer<int>(request[9]));
+    }
+
+    /**
+     * @brief Answers a Read Holding Registers request for one register.
+     */
+    static void respond(tcp::socket &socket, const ReadRequest &request, uint16_t value) {
+        std::array<std::byte, 11> response{request[0], request[1], std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+                                           std::byte{0x05}, request[6], std::byte{0x03}, std::byte{0x02},
+                                           static_cast<std::byte>(value >> 8), static_cast<std::byte>(value & 0xFF)};
+        boost::asio::write(socket, boost::asio::buffer(response));
+    }
+};
+
+TEST_F(FakeServerTest, ResponsesAreMatchedOutOfOrder) {
+    std::thread fakeServer([this]() {
+        auto socket = acceptor.accept();
+        std::array<ReadRequest, 4> requests{};
+        for (auto &request: requests)
+            boost::asio::read(socket, boost::asio::buffer(request));
+        // Every request is answered with its start address, the last request first
+        for (auto request = requests.rbegin(); request != requests.rend(); ++request)
+            respond(socket, *request, startAddressOf(*request));
+    });
+
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", acceptor.local_endpoint().port(), 1,
+                               {.window = 4});
+    std::array<uint16_t, 4> values{};
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        co_await client.connect();
+        for (int i = 0; i < 4; ++i) {
+            boost::asio::co_spawn(context, [&client, &values, i]() -> boost::asio::awaitable<void> {
+                values[i] = (co_await client.readHoldingRegisters(i * 10, 1))[0];
+            }, boost::asio::detached);
+        }
+    }, boost::asio::detached);
+    context.run();
+    fakeServer.join();
+
+    ASSERT_EQ(values, (std::array<uint16_t, 4>{0, 10, 20, 30}));
+}
+
+TEST_F(FakeServerTest, WindowLimitsRequestsInFlight) {
+    std::size_t unexpectedBytes = 0;
+    std::thread fakeServer([this, &unexpectedBytes]() {
+        auto socket = acceptor.accept();
+        for (int round = 0; round < 2; ++round) {
+            std::array<ReadRequest, 2> requests{};
+            for (auto &request: requests)
+                boost::asio::read(socket, boost::asio::buffer(request));
+            // The client must wait for a response before sending a third request
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            unexpectedBytes += socket.available();
+            for (auto &request: requests)
+                respond(socket, request, startAddressOf(request));
+        }
+    });
+
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", acceptor.local_endpoint().port(), 1,
+                               {.window = 2});
+    int completed = 0;
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        co_await client.connect();
+        for (int i = 0; i < 4; ++i) {
+            boost::asio::co_spawn(context, [&client, &completed, i]() -> boost::asio::awaitable<void> {
+                if ((co_await client.readHoldingRegisters(i, 1))[0] == i)
+                    ++completed;
+            }, boost::asio::detached);
+        }
+    }, boost::asio::detached);
+    context.run();
+    fakeServer.join();
+
+    ASSERT_EQ(unexpectedBytes, 0);
+    ASSERT_EQ(completed, 4);
+}
+
+TEST_F(FakeServerTest, TimedOutRequestLeavesConnectionOpen) {
+    std::thread fakeServer([this]() {
+        auto socket = acceptor.accept();
+        ReadRequest first{};
+        ReadRequest second{};
+        boost::asio::read(socket, boost::asio::buffer(first));
+        // The first request is only answered once the client has given up on it and sent the second
+        boost::asio::read(socket, boost::asio::buffer(second));
+        respond(socket, first, 1);
+        respond(socket, second, 2);
+    });
+
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", acceptor.local_endpoint().port(), 1,
+                               {.timeout = std::chrono::milliseconds(100)});
+    boost::system::error_code timeoutError;
+    std::vector<uint16_t> values;
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        co_await client.connect();
+        try {
+            co_await client.readHoldingRegisters(0, 1);
+        } catch (const boost::system::system_error &e) {
+            timeoutError = e.code();
+        }
+        values = co_await client.readHoldingRegisters(5, 1);
+        client.disconnect();
+    }, boost::asio::detached);
+    context.run();
+    fakeServer.join();
+
+    ASSERT_EQ(timeoutError, boost::asio::error::timed_out);
+    ASSERT_EQ(values, std::vector<uint16_t>{2});
+}
+
+TEST_F(FakeServerTest, ClosedConnectionFailsRequestsInFlight) {
+    std::thread fakeServer([this]() {
+        auto socket = acceptor.accept();
+        ReadRequest request{};
+        boost::asio::read(socket, boost::asio::buffer(request));
+    });
+
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", acceptor.local_endpoint().port());
+    bool failed = false;
+    bool failedAfterwards = false;
+    boost::asio::co_spawn(context, [&]() -> boost::asio::awaitable<void> {
+        co_await client.connect();
+        try {
+            co_await client.readHoldingRegisters(0, 1);
+        } catch (const boost::system::system_error &e) {
+            failed = e.code() == boost::asio::error::eof;
+        }
+        try {
+            co_await client.readHoldingRegisters(0, 1);
+        } catch (const boost::system::system_error &e) {
+            failedAfterwards = e.code() == boost::asio::error::eof;
+        }
+    }, boost::asio::detached);
+    context.run();
+    fakeServer.join();
+
+    ASSERT_TRUE(failed);
+    ASSERT_TRUE(failedAfterwards);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
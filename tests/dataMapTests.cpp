@@ -2,6 +2,15 @@
 // Created by Luis Johnson on 3/17/24.
 //
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "ModbusDataArea.h"
 #include "Modbus.h"
 
@@ -183,18 +192,18 @@ TEST(ModbusDataAreaTest, SortInputRegisters) {
 
 TEST(ModbusDataAreaTest, InsertCoilThrowsExceptionWhenMaxCoilsExceeded) {
     Modbus::DataArea dataArea;
-    for (int i = 1; i < Modbus::MAX_COILS + 1; i++) {
+    for (int i = 0; i < Modbus::MAX_REGISTER_DATA_AREA_SIZE; i++) {
         ASSERT_NO_THROW(dataArea.insertCoil(Modbus::Coil(i, true)));
     }
-    ASSERT_THROW(dataArea.insertCoil(Modbus::Coil(2001, true)), std::range_error);
+    ASSERT_THROW(dataArea.insertCoil(Modbus::Coil(Modbus::MAX_REGISTER_DATA_AREA_SIZE, true)), std::range_error);
 }
 
 TEST(ModbusDataAreaTest, InsertInputRegisterThorwsExceptionWhenMaxInputRegistersExceeded) {
     Modbus::DataArea dataArea;
-    for (int i = 1; i < Modbus::MAX_INPUT_REGISTERS + 1; i++) {
+    for (int i = 0; i < Modbus::MAX_REGISTER_DATA_AREA_SIZE; i++) {
         ASSERT_NO_THROW(dataArea.insertInputRegister(Modbus::InputRegister(i, 1000)));
     }
-    ASSERT_THROW(dataArea.insertInputRegister(Modbus::InputRegister(2001, 1000)),
+    ASSERT_THROW(dataArea.insertInputRegister(Modbus::InputRegister(Modbus::MAX_REGISTER_DATA_AREA_SIZE, 1000)),
                  std::range_error);
 }
 
@@ -218,6 +227,89 @@ TEST_F(ModbusDataAreaTestWithFixture, writeSingleCoil) {
     ASSERT_TRUE(coil.read());
 }
 
+TEST_F(ModbusDataAreaTestWithFixture, writeHoldingRegistersWritesWholeRange) {
+    std::vector<uint16_t> values{0x1234, 0x5678, 0x9ABC};
+    dataAreaWitTenRegistersEach.writeHoldingRegisters(4, values);
+    auto registers = dataAreaWitTenRegistersEach.getHoldingRegisters(3, 5);
+    ASSERT_EQ(registers[0].read(), 1);
+    ASSERT_EQ(registers[1].read(), 0x1234);
+    ASSERT_EQ(registers[2].read(), 0x5678);
+    ASSERT_EQ(registers[3].read(), 0x9ABC);
+    ASSERT_EQ(registers[4].read(), 1);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, writeHoldingRegistersOutOfRangeWritesNothing) {
+    std::vector<uint16_t> values{0xFFFF, 0xFFFF, 0xFFFF};
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeHoldingRegisters(8, values), std::out_of_range);
+    auto registers = dataAreaWitTenRegistersEach.getHoldingRegisters(8, 2);
+    ASSERT_EQ(registers[0].read(), 1);
+    ASSERT_EQ(registers[1].read(), 1);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, writeCoilsUnpacksBitsLsbFirst) {
+    std::vector<std::byte> packed{std::byte{0b10100000}, std::byte{0b00000001}};
+    dataAreaWitTenRegistersEach.writeCoils(0, 9, packed);
+    auto coils = dataAreaWitTenRegistersEach.getCoils(0, 10);
+    std::vector<bool> expected{false, false, false, false, false, true, false, true, true, true};
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(coils[i].read(), expected[i]) << "coil " << i;
+    }
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, coilRangesStraddlingStorageWordsRoundTrip) {
+    modbusDataArea->generateCoils(0, 256, Modbus::ValueGenerationType::Ones);
+    // 100 coils from address 60 span three 64-bit storage words
+    std::vector<std::byte> packed(13, std::byte{0b01010101});
+    modbusDataArea->writeCoils(60, 100, packed);
+
+    std::vector<std::byte> readBack(14, std::byte{0xFF});
+    modbusDataArea->readCoils(56, 108, readBack);
+    // Coils 56-59 and 160-163 keep their value, coils 60-159 alternate starting with true
+    for (int i = 0; i < 108; i++) {
+        int address = 56 + i;
+        bool expected = address < 60 || address >= 160 || (address - 60) % 2 == 0;
+        bool actual = (readBack[i / 8] & static_cast<std::byte>(1 << (i % 8))) != std::byte{0};
+        EXPECT_EQ(actual, expected) << "coil " << address;
+    }
+    // Bits past the quantity in the last byte are cleared
+    ASSERT_EQ(readBack[13] & std::byte{0xF0}, std::byte{0});
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, writeInputRegistersUpdatesWholeRange) {
+    std::vector<uint16_t> values{10, 20, 30};
+    dataAreaWitTenRegistersEach.writeInputRegisters(4, values);
+    auto registers = dataAreaWitTenRegistersEach.getInputRegisters(3, 5);
+    std::vector<uint16_t> expected{1, 10, 20, 30, 1};
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(registers[i].read(), expected[i]) << "register " << i + 3;
+    }
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeInputRegisters(8, values), std::out_of_range);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, writeDiscreteInputsUnpacksBitsLsbFirst) {
+    std::vector<std::byte> packed{std::byte{0b00000101}};
+    dataAreaWitTenRegistersEach.writeDiscreteInputs(2, 4, packed);
+    auto inputs = dataAreaWitTenRegistersEach.getDiscreteInputs(0, 10);
+    std::vector<bool> expected{true, true, true, false, true, false, true, true, true, true};
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(inputs[i].read(), expected[i]) << "input " << i;
+    }
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeDiscreteInputs(8, 4, packed), std::out_of_range);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, writeCoilsOutOfRangeWritesNothing) {
+    std::vector<std::byte> packed{std::byte{0x00}, std::byte{0x00}};
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeCoils(5, 10, packed), std::out_of_range);
+    for (auto coil: dataAreaWitTenRegistersEach.getCoils(0, 10)) {
+        ASSERT_TRUE(coil.read());
+    }
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, writeCoilsWithTooFewPackedBytesThrowsException) {
+    std::vector<std::byte> packed{std::byte{0x00}};
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeCoils(0, 9, packed), std::invalid_argument);
+}
+
 TEST_F(ModbusDataAreaTestWithFixture, generateCoilsWithZeros) {
     modbusDataArea->generateCoils(0, 10, Modbus::ValueGenerationType::Zeros);
     auto coils = modbusDataArea->getCoils(0, 10);
@@ -252,25 +344,48 @@ TEST_F(ModbusDataAreaTestWithFixture, generateInputRegistersWithIncrementalValue
     }
 }
 
+TEST_F(ModbusDataAreaTestWithFixture, generateHoldingRegistersWithMaxValues) {
+    modbusDataArea->generateHoldingRegisters(0, 10, Modbus::ValueGenerationType::Max);
+    for (auto reg: modbusDataArea->getHoldingRegisters(0, 10)) {
+        EXPECT_EQ(reg.read(), 0xFFFF);
+    }
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, generateOverExistingRegistersInsertsNothing) {
+    modbusDataArea->insertHoldingRegister(Modbus::HoldingRegister(15, 7));
+    EXPECT_THROW(modbusDataArea->generateHoldingRegisters(10, 10, Modbus::ValueGenerationType::Ones),
+                 std::invalid_argument);
+    EXPECT_EQ(modbusDataArea->getAllHoldingRegisters().size(), 1);
+    EXPECT_EQ(modbusDataArea->getHoldingRegisters(15, 1).front().read(), 7);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, generateFullSizeTables) {
+    modbusDataArea->generateCoils(0, Modbus::MAX_REGISTER_DATA_AREA_SIZE);
+    modbusDataArea->generateHoldingRegisters(0, Modbus::MAX_REGISTER_DATA_AREA_SIZE,
+                                             Modbus::ValueGenerationType::Incremental);
+    EXPECT_EQ(modbusDataArea->getAllCoils().size(), Modbus::MAX_REGISTER_DATA_AREA_SIZE);
+    EXPECT_EQ(modbusDataArea->getHoldingRegisters(65535, 1).front().read(), 65535);
+}
+
 TEST_F(ModbusDataAreaTestWithFixture, generateCoilsWithInvalidCount) {
-    EXPECT_THROW(modbusDataArea->generateCoils(0, 2001, Modbus::ValueGenerationType::Zeros),
+    EXPECT_THROW(modbusDataArea->generateCoils(0, Modbus::MAX_REGISTER_DATA_AREA_SIZE + 1, Modbus::ValueGenerationType::Zeros),
                  std::out_of_range);
 }
 
 TEST_F(ModbusDataAreaTestWithFixture, generateDiscreteInputsWithInvalidCount) {
-    EXPECT_THROW(modbusDataArea->generateDiscreteInputs(0, 2001,
+    EXPECT_THROW(modbusDataArea->generateDiscreteInputs(0, Modbus::MAX_REGISTER_DATA_AREA_SIZE + 1,
                                                         Modbus::ValueGenerationType::Zeros),
                  std::out_of_range);
 }
 
 TEST_F(ModbusDataAreaTestWithFixture, generateHoldingRegistersWithInvalidCount) {
-    EXPECT_THROW(modbusDataArea->generateHoldingRegisters(0, 126,
+    EXPECT_THROW(modbusDataArea->generateHoldingRegisters(0, Modbus::MAX_REGISTER_DATA_AREA_SIZE + 1,
                                                           Modbus::ValueGenerationType::Zeros),
                  std::out_of_range);
 }
 
 TEST_F(ModbusDataAreaTestWithFixture, generateInputRegistersWithInvalidCount) {
-    EXPECT_THROW(modbusDataArea->generateInputRegisters(0, 126,
+    EXPECT_THROW(modbusDataArea->generateInputRegisters(0, Modbus::MAX_REGISTER_DATA_AREA_SIZE + 1,
                                                         Modbus::ValueGenerationType::Zeros), std::out_of_range);
 }
 
@@ -290,6 +405,544 @@ TEST_F(ModbusDataAreaTestWithFixture, ModbusAreaRetriveMultipleHoldingsRegisters
     ASSERT_THROW(dataAreaWitTenRegistersEach.getHoldingRegisters(1, 10), std::out_of_range);
 }
 
+TEST_F(ModbusDataAreaTestWithFixture, RetrieveRangeWithGapThrowsException) {
+    modbusDataArea->insertHoldingRegister(Modbus::HoldingRegister(100, 1));
+    modbusDataArea->insertHoldingRegister(Modbus::HoldingRegister(102, 3));
+    ASSERT_THROW(modbusDataArea->getHoldingRegisters(100, 3), std::out_of_range);
+    modbusDataArea->insertHoldingRegister(Modbus::HoldingRegister(101, 2));
+    auto registers = modbusDataArea->getHoldingRegisters(100, 3);
+    ASSERT_EQ(registers[1].read(), 2);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, FullMapStorageIsAtLeastTwentyTimesSmallerThanRegisterObjects) {
+    // The layout of the polymorphic register objects the dense tables replaced, for a fixed yardstick now that
+    // HoldingRegister itself is compact
+    struct LegacyHoldingRegister {
+        virtual ~LegacyHoldingRegister() = default;
+        std::string prefix;
+        int address{};
+        uint16_t value{};
+    };
+    auto registerObjectsSize = Modbus::MAX_REGISTER_DATA_AREA_SIZE * sizeof(LegacyHoldingRegister);
+    ASSERT_LE(sizeof(Modbus::IntegerTable) * 20, registerObjectsSize);
+    ASSERT_EQ(sizeof(Modbus::AddressBitmap), 8 * 1024);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ConcurrentReadersNeverSeePartialHoldingRegisterWrites) {
+    modbusDataArea->generateHoldingRegisters(0, Modbus::MAX_HOLDING_REGISTERS);
+    std::atomic<bool> writerDone{false};
+    std::thread writer([&]() {
+        std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+        for (int i = 0; i < 20000; ++i) {
+            values.fill(static_cast<uint16_t>(i));
+            modbusDataArea->writeHoldingRegisters(0, values);
+        }
+        writerDone = true;
+    });
+
+    int tornReads = 0;
+    std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+    while (!writerDone) {
+        modbusDataArea->readHoldingRegisters(0, values);
+        if (std::any_of(values.begin(), values.end(), [&](uint16_t value) { return value != values[0]; }))
+            ++tornReads;
+    }
+    writer.join();
+    ASSERT_EQ(tornReads, 0);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ConcurrentReadersNeverSeePartialCoilWrites) {
+    constexpr int quantity = 1968;
+    modbusDataArea->generateCoils(0, quantity);
+    std::atomic<bool> writerDone{false};
+    std::thread writer([&]() {
+        std::array<std::byte, quantity / 8> packedValues{};
+        for (int i = 0; i < 20000; ++i) {
+            packedValues.fill(i % 2 == 0 ? std::byte{0xFF} : std::byte{0x00});
+            modbusDataArea->writeCoils(0, quantity, packedValues);
+        }
+        writerDone = true;
+    });
+
+    int tornReads = 0;
+    std::array<std::byte, quantity / 8> packedValues{};
+    while (!writerDone) {
+        modbusDataArea->readCoils(0, quantity, packedValues);
+        if (std::any_of(packedValues.begin(), packedValues.end(),
+                        [&](std::byte value) { return value != packedValues[0]; }))
+            ++tornReads;
+    }
+    writer.join();
+    ASSERT_EQ(tornReads, 0);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ConcurrentReadersNeverSeePartialWritesAcrossStripes) {
+    // The range straddles the boundary between the first two stripes of the table
+    constexpr int start = Modbus::StripedSequenceLock::STRIPE_SIZE - 60;
+    modbusDataArea->generateHoldingRegisters(0, 2 * Modbus::StripedSequenceLock::STRIPE_SIZE);
+    std::atomic<bool> writerDone{false};
+    std::thread writer([&]() {
+        std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+        for (int i = 0; i < 20000; ++i) {
+            values.fill(static_cast<uint16_t>(i));
+            modbusDataArea->writeHoldingRegisters(start, values);
+        }
+        writerDone = true;
+    });
+
+    int tornReads = 0;
+    std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+    while (!writerDone) {
+        modbusDataArea->readHoldingRegisters(start, values);
+        if (std::any_of(values.begin(), values.end(), [&](uint16_t value) { return value != values[0]; }))
+            ++tornReads;
+    }
+    writer.join();
+    ASSERT_EQ(tornReads, 0);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ConcurrentWritersOfDifferentTablesAndStripesDoNotInterfere) {
+    constexpr int stripeSize = Modbus::StripedSequenceLock::STRIPE_SIZE;
+    modbusDataArea->generateHoldingRegisters(0, 4 * stripeSize);
+    modbusDataArea->generateInputRegisters(0, 4 * stripeSize);
+    std::vector<std::thread> writers;
+    for (int stripe = 0; stripe < 4; ++stripe) {
+        writers.emplace_back([&, stripe]() {
+            std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+            for (int i = 0; i < 5000; ++i) {
+                values.fill(static_cast<uint16_t>(i));
+                modbusDataArea->writeHoldingRegisters(stripe * stripeSize, values);
+                modbusDataArea->writeInputRegisters(stripe * stripeSize, values);
+            }
+        });
+    }
+    for (auto &writer: writers)
+        writer.join();
+
+    for (int stripe = 0; stripe < 4; ++stripe) {
+        for (auto reg: modbusDataArea->getHoldingRegisters(stripe * stripeSize, Modbus::MAX_HOLDING_REGISTERS))
+            ASSERT_EQ(reg.read(), 4999);
+        for (auto reg: modbusDataArea->getInputRegisters(stripe * stripeSize, Modbus::MAX_INPUT_REGISTERS))
+            ASSERT_EQ(reg.read(), 4999);
+    }
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, SnapshotIsUnaffectedByLaterWrites) {
+    auto snapshot = dataAreaWitTenRegistersEach.snapshot();
+    dataAreaWitTenRegistersEach.writeSingletCoil(3, false);
+    dataAreaWitTenRegistersEach.writeSingleRegister(3, 42);
+    dataAreaWitTenRegistersEach.insertInputRegister(Modbus::InputRegister(20, 7));
+
+    ASSERT_EQ(snapshot.value(Modbus::TableType::Coils, 3), 1);
+    ASSERT_EQ(snapshot.value(Modbus::TableType::HoldingRegisters, 3), 1);
+    ASSERT_FALSE(snapshot.contains(Modbus::TableType::InputRegisters, 20));
+    ASSERT_EQ(dataAreaWitTenRegistersEach.snapshot().value(Modbus::TableType::HoldingRegisters, 3), 42);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, SnapshotOutlivesDataArea) {
+    auto snapshot = modbusDataArea->snapshot();
+    {
+        Modbus::DataArea dataArea;
+        dataArea.insertHoldingRegister(Modbus::HoldingRegister(500, 0xBEEF));
+        snapshot = dataArea.snapshot();
+    }
+    ASSERT_EQ(snapshot.value(Modbus::TableType::HoldingRegisters, 500), 0xBEEF);
+    ASSERT_EQ(snapshot.size(Modbus::TableType::HoldingRegisters), 1);
+    ASSERT_EQ(snapshot.size(Modbus::TableType::Coils), 0);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, SnapshotValueOfMissingRegisterThrowsException) {
+    auto snapshot = dataAreaWitTenRegistersEach.snapshot();
+    ASSERT_THROW(snapshot.value(Modbus::TableType::DiscreteInputs, 10), std::out_of_range);
+    ASSERT_THROW(snapshot.value(Modbus::TableType::DiscreteInputs, -1), std::out_of_range);
+    ASSERT_FALSE(snapshot.contains(Modbus::TableType::Coils, Modbus::MAX_REGISTER_DATA_AREA_SIZE));
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, SnapshotForEachVisitsRegistersInAddressOrder) {
+    modbusDataArea->insertInputRegister(Modbus::InputRegister(9000, 3));
+    modbusDataArea->insertInputRegister(Modbus::InputRegister(7, 1));
+    modbusDataArea->insertInputRegister(Modbus::InputRegister(65535, 4));
+    std::vector<std::pair<int, uint16_t>> visited;
+    modbusDataArea->snapshot().forEach(Modbus::TableType::InputRegisters,
+                                       [&](int address, uint16_t value) { visited.emplace_back(address, value); });
+
+    std::vector<std::pair<int, uint16_t>> expected{{7, 1}, {9000, 3}, {65535, 4}};
+    ASSERT_EQ(visited, expected);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ForEachRangeSkipsMissingRegisters) {
+    modbusDataArea->generateCoils(60, 10, Modbus::ValueGenerationType::Ones);
+    modbusDataArea->insertCoil(Modbus::Coil(130, false));
+    std::vector<int> addresses;
+    int sum = 0;
+    modbusDataArea->forEachRange(Modbus::TableType::Coils, 65, 100, [&](int address, uint16_t value) {
+        addresses.push_back(address);
+        sum += value;
+    });
+
+    std::vector<int> expected{65, 66, 67, 68, 69, 130};
+    ASSERT_EQ(addresses, expected);
+    ASSERT_EQ(sum, 5);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ForEachRangeOutsideDataAreaThrowsException) {
+    auto noop = [](int, uint16_t) {};
+    ASSERT_THROW(modbusDataArea->forEachRange(Modbus::TableType::HoldingRegisters, -1, 10, noop), std::out_of_range);
+    ASSERT_THROW(modbusDataArea->forEachRange(Modbus::TableType::HoldingRegisters, 65530, 10, noop),
+                 std::out_of_range);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ConcurrentSnapshotsAreConsistentWithinAndAcrossTables) {
+    constexpr int start = Modbus::StripedSequenceLock::STRIPE_SIZE - 60;
+    modbusDataArea->generateHoldingRegisters(start, Modbus::MAX_HOLDING_REGISTERS);
+    modbusDataArea->generateInputRegisters(0, 1);
+    std::atomic<bool> writerDone{false};
+    std::atomic<int> snapshotsTaken{0};
+    std::thread writer([&]() {
+        std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS> values{};
+        for (int i = 1; snapshotsTaken < 500; ++i) {
+            values.fill(static_cast<uint16_t>(i));
+            modbusDataArea->writeHoldingRegisters(start, values);
+            modbusDataArea->writeInputRegisters(0, std::array<uint16_t, 1>{static_cast<uint16_t>(i)});
+        }
+        writerDone = true;
+    });
+
+    int inconsistentSnapshots = 0;
+    while (!writerDone) {
+        auto snapshot = modbusDataArea->snapshot();
+        ++snapshotsTaken;
+        std::vector<uint16_t> values;
+        snapshot.forEach(Modbus::TableType::HoldingRegisters, [&](int, uint16_t value) { values.push_back(value); });
+        auto inputRegister = snapshot.value(Modbus::TableType::InputRegisters, 0);
+        // Each input register write follows the holding register write of the same value
+        if (std::any_of(values.begin(), values.end(), [&](uint16_t value) { return value != values[0]; }) ||
+            static_cast<uint16_t>(values[0] - inputRegister) > 1)
+            ++inconsistentSnapshots;
+    }
+    writer.join();
+    ASSERT_EQ(inconsistentSnapshots, 0);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, SubscribersAreNotifiedOncePerWrite) {
+    std::vector<Modbus::DataChange> changes;
+    dataAreaWitTenRegistersEach.subscribe([&changes](const Modbus::DataChange &change) {
+        changes.push_back(change);
+    });
+    std::array<uint16_t, 4> values{1, 2, 3, 4};
+    std::array<std::byte, 1> packedValues{std::byte{0b101}};
+
+    dataAreaWitTenRegistersEach.writeSingletCoil(2, false);
+    dataAreaWitTenRegistersEach.writeSingleRegister(7, 9);
+    dataAreaWitTenRegistersEach.writeCoils(1, 3, packedValues);
+    dataAreaWitTenRegistersEach.writeDiscreteInputs(4, 3, packedValues);
+    dataAreaWitTenRegistersEach.writeHoldingRegisters(6, values);
+    dataAreaWitTenRegistersEach.writeInputRegisters(0, values);
+
+    std::vector<Modbus::DataChange> expected{{Modbus::TableType::Coils, 2, 1},
+                                             {Modbus::TableType::HoldingRegisters, 7, 1},
+                                             {Modbus::TableType::Coils, 1, 3},
+                                             {Modbus::TableType::DiscreteInputs, 4, 3},
+                                             {Modbus::TableType::HoldingRegisters, 6, 4},
+                                             {Modbus::TableType::InputRegisters, 0, 4}};
+    ASSERT_EQ(changes, expected);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, FailedWritesAndInsertionsAreNotNotified) {
+    int notifications = 0;
+    dataAreaWitTenRegistersEach.subscribe([&notifications](const Modbus::DataChange &) { ++notifications; });
+    std::array<uint16_t, 4> values{};
+
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeSingleRegister(10, 1), std::out_of_range);
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeHoldingRegisters(8, values), std::out_of_range);
+    dataAreaWitTenRegistersEach.insertHoldingRegister(Modbus::HoldingRegister(20, 1));
+    dataAreaWitTenRegistersEach.generateCoils(100, 10);
+
+    ASSERT_EQ(notifications, 0);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, SubscriberSeesWrittenValues) {
+    uint16_t seen = 0;
+    dataAreaWitTenRegistersEach.subscribe([&](const Modbus::DataChange &change) {
+        seen = dataAreaWitTenRegistersEach.getHoldingRegisters(change.start, 1)[0].read();
+    });
+    dataAreaWitTenRegistersEach.writeSingleRegister(5, 321);
+    ASSERT_EQ(seen, 321);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, UnsubscribedCallbackIsNoLongerNotified) {
+    int first = 0;
+    int second = 0;
+    auto subscription = dataAreaWitTenRegistersEach.subscribe([&first](const Modbus::DataChange &) { ++first; });
+    dataAreaWitTenRegistersEach.subscribe([&second](const Modbus::DataChange &) { ++second; });
+
+    dataAreaWitTenRegistersEach.writeSingleRegister(0, 1);
+    dataAreaWitTenRegistersEach.unsubscribe(subscription);
+    dataAreaWitTenRegistersEach.writeSingleRegister(0, 2);
+
+    ASSERT_EQ(first, 1);
+    ASSERT_EQ(second, 2);
+    ASSERT_THROW(dataAreaWitTenRegistersEach.unsubscribe(subscription), std::invalid_argument);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ConcurrentSubscriptionsAndWritesAreSafe) {
+    std::atomic<long> notifications{0};
+    std::atomic<bool> subscriberDone{false};
+    std::thread writer([&]() {
+        while (!subscriberDone)
+            dataAreaWitTenRegistersEach.writeSingleRegister(0, 1);
+    });
+
+    for (int i = 0; i < 1000; ++i) {
+        auto subscription = dataAreaWitTenRegistersEach.subscribe([&notifications](const Modbus::DataChange &) {
+            ++notifications;
+        });
+        std::this_thread::yield();
+        dataAreaWitTenRegistersEach.unsubscribe(subscription);
+    }
+    subscriberDone = true;
+    writer.join();
+
+    auto notified = notifications.load();
+    dataAreaWitTenRegistersEach.writeSingleRegister(0, 2);
+    ASSERT_EQ(notifications, notified);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, CollectChangesOfUntouchedDataAreaIsEmpty) {
+    auto changeSet = modbusDataArea->collectChanges(0);
+    ASSERT_EQ(changeSet.version, 0);
+    ASSERT_TRUE(changeSet.changes.empty());
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, CollectChangesReportsBlocksWrittenSinceVersion) {
+    auto initial = dataAreaWitTenRegistersEach.collectChanges(0);
+    std::vector<Modbus::DataChange> generated{{Modbus::TableType::Coils, 0, 64},
+                                              {Modbus::TableType::DiscreteInputs, 0, 64},
+                                              {Modbus::TableType::HoldingRegisters, 0, 64},
+                                              {Modbus::TableType::InputRegisters, 0, 64}};
+    ASSERT_EQ(initial.changes, generated);
+
+    dataAreaWitTenRegistersEach.insertHoldingRegister(Modbus::HoldingRegister(5000, 1));
+    dataAreaWitTenRegistersEach.insertCoil(Modbus::Coil(130, true));
+    auto changeSet = dataAreaWitTenRegistersEach.collectChanges(initial.version);
+
+    std::vector<Modbus::DataChange> expected{{Modbus::TableType::Coils, 128, 64},
+                                             {Modbus::TableType::HoldingRegisters, 4992, 64}};
+    ASSERT_EQ(changeSet.changes, expected);
+    ASSERT_GT(changeSet.version, initial.version);
+    ASSERT_TRUE(dataAreaWitTenRegistersEach.collectChanges(changeSet.version).changes.empty());
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, CollectChangesMergesRangesAcrossStripes) {
+    constexpr int start = Modbus::StripedSequenceLock::STRIPE_SIZE - 10;
+    modbusDataArea->generateHoldingRegisters(start, 20);
+    auto changeSet = modbusDataArea->collectChanges(0);
+
+    std::vector<Modbus::DataChange> expected{{Modbus::TableType::HoldingRegisters, start - 54, 128}};
+    ASSERT_EQ(changeSet.changes, expected);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, FailedWritesAreNotCollected) {
+    auto version = dataAreaWitTenRegistersEach.version();
+    ASSERT_THROW(dataAreaWitTenRegistersEach.writeSingleRegister(10, 1), std::out_of_range);
+    ASSERT_THROW(dataAreaWitTenRegistersEach.insertCoil(Modbus::Coil(0, true)), std::invalid_argument);
+    ASSERT_EQ(dataAreaWitTenRegistersEach.version(), version);
+    ASSERT_TRUE(dataAreaWitTenRegistersEach.collectChanges(version).changes.empty());
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, ReplicaFedWithCollectedChangesConvergesUnderConcurrentWrites) {
+    constexpr int size = 4 * Modbus::StripedSequenceLock::STRIPE_SIZE;
+    modbusDataArea->generateHoldingRegisters(0, size);
+    std::atomic<bool> writerDone{false};
+    std::atomic<int> collections{0};
+    std::thread writer([&]() {
+        for (uint16_t i = 1; collections < 200; ++i)
+            modbusDataArea->writeSingleRegister(static_cast<int>((i * 7919U) % size), i);
+        writerDone = true;
+    });
+
+    std::vector<uint16_t> replica(size);
+    uint64_t version = 0;
+    auto synchronize = [&]() {
+        auto changeSet = modbusDataArea->collectChanges(version);
+        for (const auto &change: changeSet.changes)
+            modbusDataArea->forEachRange(change.table, change.start, change.count,
+                                         [&](int address, uint16_t value) { replica[address] = value; });
+        version = changeSet.version;
+    };
+    while (!writerDone) {
+        synchronize();
+        ++collections;
+    }
+    writer.join();
+    synchronize();
+
+    auto snapshot = modbusDataArea->snapshot();
+    for (int address = 0; address < size; ++address)
+        ASSERT_EQ(replica[address], snapshot.value(Modbus::TableType::HoldingRegisters, address));
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, TryAccessReportsFailuresWithoutThrowing) {
+    auto version = dataAreaWitTenRegistersEach.version();
+    std::array<uint16_t, Modbus::MAX_HOLDING_REGISTERS + 1> values{};
+    auto missing = dataAreaWitTenRegistersEach.tryReadHoldingRegisters(5, std::span(values).first(10));
+    ASSERT_FALSE(missing);
+    ASSERT_EQ(missing.error(), Modbus::AccessError::InvalidAddress);
+    ASSERT_EQ(dataAreaWitTenRegistersEach.tryReadHoldingRegisters(0, values).error(),
+              Modbus::AccessError::InvalidQuantity);
+
+    std::array<std::byte, 1> packed{std::byte{0xFF}};
+    ASSERT_EQ(dataAreaWitTenRegistersEach.tryWriteCoils(0, 9, packed).error(), Modbus::AccessError::BufferTooSmall);
+    ASSERT_EQ(dataAreaWitTenRegistersEach.tryWriteSingleRegister(10, 1).error(), Modbus::AccessError::InvalidAddress);
+    ASSERT_EQ(dataAreaWitTenRegistersEach.version(), version);
+}
+
+TEST_F(ModbusDataAreaTestWithFixture, TryAccessSucceedsLikeThrowingAccess) {
+    std::vector<Modbus::DataChange> changes;
+    dataAreaWitTenRegistersEach.subscribe([&changes](const Modbus::DataChange &change) { changes.push_back(change); });
+    std::array<uint16_t, 2> written{5, 6};
+    ASSERT_TRUE(dataAreaWitTenRegistersEach.tryWriteHoldingRegisters(8, written));
+
+    std::array<uint16_t, 2> values{};
+    auto result = dataAreaWitTenRegistersEach.tryReadHoldingRegisters(8, values);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(values, written);
+    ASSERT_EQ(changes, (std::vector<Modbus::DataChange>{{Modbus::TableType::HoldingRegisters, 8, 2}}));
+}
+
+std::filesystem::path temporaryTableFile() {
+    auto name = std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + "-" +
+                std::to_string(::getpid()) + ".mbdata";
+    auto file = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(file);
+    return file;
+}
+
+TEST(ModbusMappedDataAreaTest, RegistersSurviveReopeningTheFile) {
+    auto file = temporaryTableFile();
+    std::array<uint16_t, 3> written{7, 8, 9};
+    uint64_t version;
+    {
+        Modbus::DataArea dataArea(file, {std::chrono::milliseconds(0)});
+        dataArea.generateHoldingRegisters(100, 3, Modbus::ValueGenerationType::Zeros);
+        dataArea.generateCoils(0, 16, Modbus::ValueGenerationType::Zeros);
+        dataArea.writeHoldingRegisters(100, written);
+        dataArea.writeSingletCoil(5, true);
+        version = dataArea.version();
+    }
+    Modbus::DataArea reopened(file);
+    std::array<uint16_t, 3> values{};
+    reopened.readHoldingRegisters(100, values);
+    ASSERT_EQ(values, written);
+    ASSERT_EQ(reopened.getAllCoils().size(), 16);
+    ASSERT_TRUE(reopened.getCoils(5, 1)[0].read());
+    ASSERT_FALSE(reopened.getCoils(4, 1)[0].read());
+    ASSERT_EQ(reopened.version(), version);
+    ASSERT_TRUE(reopened.getAllInputRegisters().empty());
+    std::filesystem::remove(file);
+}
+
+TEST(ModbusMappedDataAreaTest, FileIsUsedByOneDataAreaAtATime) {
+    auto file = temporaryTableFile();
+    {
+        Modbus::DataArea dataArea(file);
+        ASSERT_THROW(Modbus::DataArea second(file), std::system_error);
+    }
+    ASSERT_NO_THROW(Modbus::DataArea reopened(file));
+    std::filesystem::remove(file);
+}
+
+TEST(ModbusMappedDataAreaTest, FileWithForeignContentIsRejected) {
+    auto file = temporaryTableFile();
+    std::ofstream(file) << "not a table file";
+    ASSERT_THROW(Modbus::DataArea dataArea(file), std::invalid_argument);
+    ASSERT_THROW(Modbus::MappedFileView view(file), std::invalid_argument);
+    std::filesystem::remove(file);
+}
+
+TEST(ModbusMappedDataAreaTest, ViewReadsTablesWhileTheDataAreaWrites) {
+    auto file = temporaryTableFile();
+    Modbus::DataArea dataArea(file);
+    dataArea.generateInputRegisters(0, 2, Modbus::ValueGenerationType::Zeros);
+    Modbus::MappedFileView view(file);
+    const auto &inputRegisters = view.tables().inputRegisters;
+    ASSERT_TRUE(inputRegisters.occupied.test(1));
+    ASSERT_FALSE(inputRegisters.occupied.test(2));
+
+    std::array<uint16_t, 2> written{0x1234, 0x5678};
+    dataArea.writeInputRegisters(0, written);
+    dataArea.flush();
+    auto values = inputRegisters.stripes.read(0, 2, [&]() {
+        return std::array<uint16_t, 2>{inputRegisters.read(0), inputRegisters.read(1)};
+    });
+    ASSERT_EQ(values, written);
+    std::filesystem::remove(file);
+}
+
+std::string temporarySegmentName() {
+    return "/" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + "-" +
+           std::to_string(::getpid());
+}
+
+/**
+ * @brief Runs fn in a child process and returns whether it exited with true.
+ */
+template<typename Function>
+bool runInChildProcess(Function &&fn) {
+    auto child = ::fork();
+    if (child == 0)
+        ::_exit(fn() ? 0 : 1);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+TEST(ModbusSharedMemoryDataAreaTest, ProcessesShareRegistersAndChanges) {
+    auto name = temporarySegmentName();
+    Modbus::DataArea dataArea(std::make_unique<Modbus::SharedMemoryDataStore>(name, Modbus::SharedMemoryMode::Create));
+    dataArea.generateHoldingRegisters(0, 10, Modbus::ValueGenerationType::Zeros);
+    auto version = dataArea.version();
+
+    std::array<uint16_t, 3> written{1, 2, 3};
+    ASSERT_TRUE(runInChildProcess([&]() {
+        Modbus::DataArea attached(
+                std::make_unique<Modbus::SharedMemoryDataStore>(name, Modbus::SharedMemoryMode::Attach));
+        attached.writeHoldingRegisters(4, written);
+        return attached.getAllHoldingRegisters().size() == 10;
+    }));
+
+    std::array<uint16_t, 3> values{};
+    dataArea.readHoldingRegisters(4, values);
+    ASSERT_EQ(values, written);
+    auto changeSet = dataArea.collectChanges(version);
+    ASSERT_EQ(changeSet.changes.size(), 1);
+    ASSERT_EQ(changeSet.changes[0].table, Modbus::TableType::HoldingRegisters);
+}
+
+TEST(ModbusSharedMemoryDataAreaTest, WriterDyingInsideWriteDoesNotBlockOtherProcesses) {
+    auto name = temporarySegmentName();
+    Modbus::DataArea dataArea(std::make_unique<Modbus::SharedMemoryDataStore>(name, Modbus::SharedMemoryMode::Create));
+    dataArea.generateHoldingRegisters(0, 10, Modbus::ValueGenerationType::Zeros);
+
+    runInChildProcess([&]() {
+        Modbus::SharedMemoryDataStore attached(name, Modbus::SharedMemoryMode::Attach);
+        attached.tables().holdingRegisters.stripes.write(0, 1, []() {
+            ::_exit(0);
+            return true;
+        });
+        return false;
+    });
+
+    dataArea.writeSingleRegister(0, 42);
+    std::array<uint16_t, 1> value{};
+    dataArea.readHoldingRegisters(0, value);
+    ASSERT_EQ(value[0], 42);
+}
+
+TEST(ModbusSharedMemoryDataAreaTest, AttachingToMissingSegmentThrowsException) {
+    ASSERT_THROW(Modbus::SharedMemoryDataStore(temporarySegmentName(), Modbus::SharedMemoryMode::Attach),
+                 std::system_error);
+}
 
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <ModbusFrameAssembler.h>
+#include <ModbusPDU.h>
+
+class FrameAssemblerTest : public ::testing::Test {
+protected:
+    Modbus::FrameAssembler assembler;
+
+    // Read Holding Registers request with the given transaction identifier
+    static std::vector<std::byte> readHoldingRegistersFrame(uint8_t transactionIdentifier) {
+        return {std::byte{0x00}, std::byte{transactionIdentifier}, // Transaction Identifier
+                std::byte{0x00}, std::byte{0x00}, // Protocol Identifier
+                std::byte{0x00}, std::byte{0x06}, // Length = 6
+                std::byte{0x01}, // Unit Identifier
+                std::byte{0x03}, // Function code: Read Holding Registers (3)
+                std::byte{0x00}, std::byte{0x00}, // Starting address = 0
+                std::byte{0x00}, std::byte{0x01}}; // Quantity = 1
+    }
+
+    void receive(std::span<const std::byte> bytes) {
+        auto space = assembler.prepare();
+        std::copy(bytes.begin(), bytes.end(), space.begin());
+        assembler.commit(bytes.size());
+    }
+};
+
+TEST_F(FrameAssemblerTest, SingleCompleteFrameIsExtracted) {
+    auto request = readHoldingRegistersFrame(1);
+    receive(request);
+
+    auto frame = assembler.nextFrame();
+    ASSERT_TRUE(frame.has_value());
+    ASSERT_TRUE(std::equal(frame->begin(), frame->end(), request.begin(), request.end()));
+    ASSERT_FALSE(assembler.nextFrame().has_value());
+    ASSERT_EQ(assembler.pendingBytes(), 0);
+}
+
+TEST_F(FrameAssemblerTest, PipelinedFramesAreExtractedInOrder) {
+    std::vector<std::byte> bytes;
+    for (uint8_t i = 1; i <= 3; i++) {
+        auto request = readHoldingRegistersFrame(i);
+        bytes.insert(bytes.end(), request.begin(), request.end());
+    }
+    receive(bytes);
+
+    for (uint8_t i = 1; i <= 3; i++) {
+        auto frame = assembler.nextFrame();
+        ASSERT_TRUE(frame.has_value());
+        ASSERT_EQ(frame->size(), 12);
+        ASSERT_EQ(Modbus::bytesToMBAP(*frame).transactionIdentifier, i);
+    }
+    ASSERT_FALSE(assembler.nextFrame().has_value());
+}
+
+TEST_F(FrameAssemblerTest, PartialHeaderWaitsForMoreBytes) {
+    auto request = readHoldingRegistersFrame(7);
+    receive(std::span(request).first(4));
+    ASSERT_FALSE(assembler.nextFrame().has_value());
+
+    receive(std::span(request).subspan(4, 5));
+    ASSERT_FALSE(assembler.nextFrame().has_value());
+
+    receive(std::span(request).subspan(9));
+    auto frame = assembler.nextFrame();
+    ASSERT_TRUE(frame.has_value());
+    ASSERT_EQ(Modbus::bytesToMBAP(*frame).transactionIdentifier, 7);
+}
+
+TEST_F(FrameAssemblerTest, FrameSplitAcrossReadsKeepsFollowingPartialFrame) {
+    auto first = readHoldingRegistersFrame(1);
+    auto second = readHoldingRegistersFrame(2);
+    std::vector<std::byte> bytes(first);
+    bytes.insert(bytes.end(), second.begin(), second.begin() + 3);
+    receive(bytes);
+
+    ASSERT_EQ(Modbus::bytesToMBAP(*assembler.nextFrame()).transactionIdentifier, 1);
+    ASSERT_FALSE(assembler.nextFrame().has_value());
+    ASSERT_EQ(assembler.pendingBytes(), 3);
+
+    receive(std::span(second).subspan(3));
+    ASSERT_EQ(Modbus::bytesToMBAP(*assembler.nextFrame()).transactionIdentifier, 2);
+}
+
+TEST_F(FrameAssemblerTest, ManyFramesDoNotExhaustTheBuffer) {
+    for (int i = 0; i < 1000; i++) {
+        auto request = readHoldingRegistersFrame(static_cast<uint8_t>(i));
+        // Feed the stream in uneven chunks so that frames straddle reads
+        receive(std::span(request).first(5));
+        receive(std::span(request).subspan(5));
+        auto frame = assembler.nextFrame();
+        ASSERT_TRUE(frame.has_value());
+        ASSERT_EQ(Modbus::bytesToMBAP(*frame).transactionIdentifier, static_cast<uint8_t>(i));
+    }
+    ASSERT_GE(assembler.prepare().size(), Modbus::FrameAssembler::BUFFER_SIZE - Modbus::MAX_ADU_LENGTH);
+}
+
+TEST_F(FrameAssemblerTest, InvalidLengthThrowsException) {
+    auto request = readHoldingRegistersFrame(1);
+    request[4] = std::byte{0x01}; // Length = 262, more than a PDU can hold
+    receive(request);
+    ASSERT_THROW(assembler.nextFrame(), std::invalid_argument);
+}
+
+TEST_F(FrameAssemblerTest, CommitBeyondPreparedSpaceThrowsException) {
+    auto space = assembler.prepare();
+    ASSERT_THROW(assembler.commit(space.size() + 1), std::out_of_range);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
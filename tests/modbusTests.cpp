@@ -4,6 +4,8 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <cstddef>
+#include <type_traits>
+#include <vector>
 #include "Modbus.h"
 
 
@@ -47,6 +49,37 @@ TEST(ModbusHoldingRegisterTest, GetAddressWithHexPrefixReturnsCorrectFormat) {
     ASSERT_EQ("4x00123", reg.getAddressWithHexPrefix());
 }
 
+TEST(ModbusRegisterTest, RegistersAreCompactAndTriviallyCopyable) {
+    ASSERT_TRUE(std::is_trivially_copyable_v<Modbus::Coil>);
+    ASSERT_TRUE(std::is_trivially_copyable_v<Modbus::DiscreteInput>);
+    ASSERT_TRUE(std::is_trivially_copyable_v<Modbus::InputRegister>);
+    ASSERT_TRUE(std::is_trivially_copyable_v<Modbus::HoldingRegister>);
+    ASSERT_FALSE(std::is_polymorphic_v<Modbus::HoldingRegister>);
+    ASSERT_LE(sizeof(Modbus::Coil), 8);
+    ASSERT_LE(sizeof(Modbus::DiscreteInput), 8);
+    ASSERT_LE(sizeof(Modbus::InputRegister), 8);
+    ASSERT_LE(sizeof(Modbus::HoldingRegister), 8);
+}
+
+TEST(ModbusRegisterTest, RegistersAreUsableInConstantExpressions) {
+    constexpr Modbus::HoldingRegister reg(40, 0x1234);
+    static_assert(reg.read() == 0x1234 && reg.getAddress() == 40);
+    static_assert(Modbus::HoldingRegister::PREFIX == '4');
+    ASSERT_EQ("400040", reg.getAddressWithPrefix());
+}
+
+TEST(ModbusRegisterTest, PolymorphicRegisterForwardsToWrappedRegister) {
+    std::vector<std::unique_ptr<Modbus::RegisterInterface<bool>>> points;
+    points.push_back(std::make_unique<Modbus::PolymorphicRegister<Modbus::Coil>>(Modbus::Coil(1, true)));
+    points.push_back(std::make_unique<Modbus::PolymorphicRegister<Modbus::DiscreteInput>>(
+            Modbus::DiscreteInput(2, false)));
+    points[1]->write(true);
+    ASSERT_TRUE(points[0]->read());
+    ASSERT_TRUE(points[1]->read());
+    ASSERT_EQ(points[1]->getAddress(), 2);
+    ASSERT_EQ("100002", points[1]->getAddressWithPrefix());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -899,6 +899,123 @@ TEST_F(ModbusPDUTest, WriteMultipleRegistersCorrectResponse) {
     ASSERT_EQ(response[4], std::byte{0x7B}); // Quantity of Registers LSB
 }
 
+TEST_F(ModbusPDUTest, WriteMultipleRegistersNotifiesOneChangePerRequest) {
+    std::vector<Modbus::DataChange> changes;
+    modbusDataAreaWithMaxRegisters.subscribe([&changes](const Modbus::DataChange &change) {
+        changes.push_back(change);
+    });
+    std::vector<std::byte> rawData = {std::byte{0x10}, // Function Code: Write Multiple Registers (16)
+                                      std::byte{0x00}, // Starting Address MSB
+                                      std::byte{0x02}, // Starting Address LSB; Starting Address = 2
+                                      std::byte{0x00}, // Quantity of Registers MSB
+                                      std::byte{0x03}, // Quantity of Registers LSB; Quantity of Registers = 3
+                                      std::byte{0x06}, // Byte Count = 3 * 2 = 6
+                                      std::byte{0x00}, std::byte{0x01},
+                                      std::byte{0x00}, std::byte{0x02},
+                                      std::byte{0x00}, std::byte{0x03}};
+
+    Modbus::PDU pdu(rawData, modbusDataAreaWithMaxRegisters);
+    pdu.buildResponse();
+
+    ASSERT_EQ(changes.size(), 1);
+    ASSERT_EQ(changes[0], (Modbus::DataChange{Modbus::TableType::HoldingRegisters, 2, 3}));
+}
+
+/********************************************************************************************************************
+    Truncated Request Tests
+    The server parses requests in place from its receive buffer, where the bytes after a truncated request belong to
+    the next frame. Every write handler must answer a request too short for its header or its byte count with an
+    Illegal Data Value exception, without reading past the request or writing anything.
+ ********************************************************************************************************************/
+
+namespace {
+    // Parses request as the server does: in place, followed in the buffer by bytes of another frame. The filler is
+    // chosen to make a valid request of whatever a handler reads past the end.
+    std::vector<std::byte> respondInPlace(std::vector<std::byte> request, Modbus::DataArea &dataArea,
+                                          std::byte filler) {
+        auto length = request.size();
+        request.resize(length + 256, filler);
+        Modbus::PDU pdu(std::span<const std::byte>(request).first(length), dataArea);
+        return pdu.buildResponse();
+    }
+}
+
+TEST_F(ModbusPDUTest, TruncatedWriteSingleCoilReturnsIllegalDataValue) {
+    auto response = respondInPlace({std::byte{0x05}, std::byte{0x00}, std::byte{0x01}, std::byte{0xFF}},
+                                   modbusDataAreaWithMaxRegisters, std::byte{0x00});
+
+    ASSERT_EQ(response, (std::vector<std::byte>{std::byte{0x85}, std::byte{0x03}}));
+    ASSERT_FALSE(modbusDataAreaWithMaxRegisters.getCoils(1, 1).front().read());
+}
+
+TEST_F(ModbusPDUTest, TruncatedWriteSingleRegisterReturnsIllegalDataValue) {
+    auto response = respondInPlace({std::byte{0x06}, std::byte{0x00}, std::byte{0x01}, std::byte{0xAB}},
+                                   modbusDataAreaWithMaxRegisters, std::byte{0xFF});
+
+    ASSERT_EQ(response, (std::vector<std::byte>{std::byte{0x86}, std::byte{0x03}}));
+    ASSERT_EQ(modbusDataAreaWithMaxRegisters.getHoldingRegisters(1, 1).front().read(), 0);
+}
+
+TEST_F(ModbusPDUTest, TruncatedWriteMultipleCoilsReturnsIllegalDataValue) {
+    // Address and quantity of 1968 coils, but no byte count and no values
+    auto response = respondInPlace({std::byte{0x0F}, std::byte{0x00}, std::byte{0x00}, std::byte{0x07},
+                                    std::byte{0xB0}}, modbusDataAreaWithMaxRegisters, std::byte{0xF6});
+    ASSERT_EQ(response, (std::vector<std::byte>{std::byte{0x8F}, std::byte{0x03}}));
+
+    // A byte count of 246 for 1968 coils, but only one byte of values
+    response = respondInPlace({std::byte{0x0F}, std::byte{0x00}, std::byte{0x00}, std::byte{0x07}, std::byte{0xB0},
+                               std::byte{0xF6}, std::byte{0xFF}}, modbusDataAreaWithMaxRegisters, std::byte{0xFF});
+    ASSERT_EQ(response, (std::vector<std::byte>{std::byte{0x8F}, std::byte{0x03}}));
+
+    for (auto coil: modbusDataAreaWithMaxRegisters.getCoils(0, Modbus::MAX_COILS))
+        ASSERT_FALSE(coil.read());
+}
+
+TEST_F(ModbusPDUTest, TruncatedWriteMultipleRegistersReturnsIllegalDataValue) {
+    // Address and quantity of 2 registers, but no byte count and no values
+    auto response = respondInPlace({std::byte{0x10}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00},
+                                    std::byte{0x02}}, modbusDataAreaWithMaxRegisters, std::byte{0x04});
+    ASSERT_EQ(response, (std::vector<std::byte>{std::byte{0x90}, std::byte{0x03}}));
+
+    // A byte count of 4 for 2 registers, but only one register of values
+    response = respondInPlace({std::byte{0x10}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x02},
+                               std::byte{0x04}, std::byte{0x12}, std::byte{0x34}}, modbusDataAreaWithMaxRegisters,
+                              std::byte{0x56});
+    ASSERT_EQ(response, (std::vector<std::byte>{std::byte{0x90}, std::byte{0x03}}));
+
+    for (auto reg: modbusDataAreaWithMaxRegisters.getHoldingRegisters(0, 2))
+        ASSERT_EQ(reg.read(), 0);
+}
+
+TEST_F(ModbusPDUTest, EmptyPDUThrowsException) {
+    ASSERT_THROW(Modbus::PDU(std::vector<std::byte>{}, modbusDataAreaWithTenRegistersEach), std::invalid_argument);
+    ASSERT_THROW(Modbus::PDU(std::span<const std::byte>(), modbusDataAreaWithTenRegistersEach),
+                 std::invalid_argument);
+}
+
+TEST_F(ModbusPDUTest, BuildResponseIntoBufferMatchesVectorResponse) {
+    std::vector<std::byte> rawData = {std::byte{0x01}, // Function code: Read Coils (1)
+                                      std::byte{0x00}, // Starting address MSB
+                                      std::byte{0x00}, // Starting address LSB; Address = 0
+                                      std::byte{0x00}, // Quantity of coils MSB
+                                      std::byte{0x0A}}; // Quantity of coils LSB; Quantity = 10
+    Modbus::PDU pdu(rawData, modbusDataAreaWithTenRegistersEach);
+    std::array<std::byte, Modbus::MAX_PDU_LENGTH> buffer{};
+
+    auto size = pdu.buildResponse(buffer);
+    auto response = pdu.buildResponse();
+
+    ASSERT_EQ(size, response.size());
+    ASSERT_TRUE(std::equal(response.begin(), response.end(), buffer.begin()));
+}
+
+TEST_F(ModbusPDUTest, BuildResponseIntoTooSmallBufferThrowsException) {
+    Modbus::PDU pdu({std::byte{0x03}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x01}},
+                    modbusDataAreaWithTenRegistersEach);
+    std::array<std::byte, 4> buffer{};
+    ASSERT_THROW(pdu.buildResponse(buffer), std::invalid_argument);
+}
+
 TEST(ModbusTest, BytesToMBAPReturnsCorrectMBAPForValidBytes) {
     std::vector<std::byte> bytes = {std::byte(0x01), // Transaction Identifier MSB
                                     std::byte(0x02),  // Transaction Identifier LSB
@@ -948,6 +1065,17 @@ TEST(ModbusTest, MBAPToBytesReturnsCorrectBytesForValidMBAP) {
     EXPECT_EQ(expectedBytes, actualBytes);
 }
 
+TEST(ModbusTest, WriteMBAPWritesSameBytesAsMBAPToBytes) {
+    Modbus::MBAP mbap{0x0102, 0x0000, 0x0006, 0x11};
+    std::array<std::byte, Modbus::MBAP_HEADER_LENGTH> buffer{};
+
+    auto size = Modbus::writeMBAP(mbap, buffer);
+    auto expectedBytes = Modbus::MBAPToBytes(mbap);
+
+    ASSERT_EQ(size, Modbus::MBAP_HEADER_LENGTH);
+    ASSERT_TRUE(std::equal(expectedBytes.begin(), expectedBytes.end(), buffer.begin()));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <ModbusAsyncClient.h>
+#include <ModbusDataArea.h>
+#include <ModbusPollScheduler.h>
+#include <ModbusServer.h>
+
+using boost::asio::ip::tcp;
+using namespace std::chrono_literals;
+
+namespace {
+    /**
+     * @brief Connects the clients and starts the scheduler on context, runs it for duration, then stops it and
+     * disconnects the clients.
+     */
+    void runFor(boost::asio::io_context &context, Modbus::PollScheduler &scheduler,
+                std::vector<Modbus::AsyncClient *> clients, std::chrono::milliseconds duration) {
+        boost::asio::co_spawn(context, [&context, &scheduler, clients, duration]() -> boost::asio::awaitable<void> {
+            for (auto *client: clients)
+                co_await client->connect();
+            scheduler.start();
+            boost::asio::steady_timer end(context, duration);
+            co_await end.async_wait(boost::asio::use_awaitable);
+            scheduler.stop();
+            for (auto *client: clients)
+                client->disconnect();
+        }, boost::asio::detached);
+        context.run();
+    }
+}
+
+class PollSchedulerTest : public ::testing::Test {
+protected:
+    Modbus::DataArea device;
+    std::unique_ptr<Modbus::Server::MBServer> server;
+    std::thread serverThread;
+    boost::asio::io_context context;
+
+    void SetUp() override {
+        device.generateCoils(0, 100, Modbus::ValueGenerationType::Random);
+        device.generateDiscreteInputs(0, 100, Modbus::ValueGenerationType::Ones);
+        device.generateHoldingRegisters(0, 500, Modbus::ValueGenerationType::Random);
+        device.generateInputRegisters(0, 100, Modbus::ValueGenerationType::Incremental);
+
+        Modbus::Server::ServerOptions options;
+        options.endpoints = {tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)};
+        options.workerThreads = 1;
+        server = std::make_unique<Modbus::Server::MBServer>(device, options);
+        serverThread = std::thread([this]() { server->start(); });
+    }
+
+    void TearDown() override {
+        server->stop();
+        serverThread.join();
+    }
+
+    uint16_t port() {
+        return server->localEndpoints().front().port();
+    }
+};
+
+TEST_F(PollSchedulerTest, TagsArePublishedIntoTheMirror) {
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", port());
+    Modbus::DataArea mirror;
+    Modbus::PollScheduler scheduler(context.get_executor());
+    auto id = scheduler.addDevice(client, mirror);
+    scheduler.addTag(id, {Modbus::TableType::HoldingRegisters, 10}, 20ms);
+    scheduler.addTag(id, {Modbus::TableType::HoldingRegisters, 400}, 20ms);
+    scheduler.addTag(id, {Modbus::TableType::Coils, 5}, 50ms);
+    scheduler.addTag(id, {Modbus::TableType::DiscreteInputs, 7}, 50ms);
+    scheduler.addTag(id, {Modbus::TableType::InputRegisters, 3}, 50ms);
+    runFor(context, scheduler, {&client}, 120ms);
+
+    std::array<uint16_t, 1> expected{};
+    std::array<uint16_t, 1> published{};
+    for (int address: {10, 400}) {
+        device.readHoldingRegisters(address, expected);
+        mirror.readHoldingRegisters(address, published);
+        ASSERT_EQ(published, expected);
+    }
+    device.readInputRegisters(3, expected);
+    mirror.readInputRegisters(3, published);
+    ASSERT_EQ(published, expected);
+    std::array<std::byte, 1> expectedBits{};
+    std::array<std::byte, 1> publishedBits{};
+    device.readCoils(5, 1, expectedBits);
+    mirror.readCoils(5, 1, publishedBits);
+    ASSERT_EQ(publishedBits, expectedBits);
+    mirror.readDiscreteInputs(7, 1, publishedBits);
+    ASSERT_EQ(publishedBits[0], std::byte{0x01});
+
+    auto statistics = scheduler.statistics();
+    ASSERT_EQ(statistics.size(), 2);
+    ASSERT_EQ(statistics[0].scanRate, 20ms);
+    ASSERT_GE(statistics[0].scans, 3);
+    ASSERT_EQ(statistics[1].scanRate, 50ms);
+    ASSERT_GE(statistics[1].scans, 2);
+    ASSERT_EQ(statistics[0].failedPolls + statistics[1].failedPolls, 0);
+    ASSERT_GE(statistics[0].maxJitter, statistics[0].meanJitter());
+}
+
+TEST_F(PollSchedulerTest, OverlappingScanClassesShareTheMirror) {
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", port());
+    Modbus::DataArea mirror;
+    // Already held by the mirror, within the ranges of both scan classes
+    mirror.generateHoldingRegisters(1007, 1);
+    Modbus::PollScheduler scheduler(context.get_executor());
+    auto id = scheduler.addDevice(client, mirror);
+    device.generateHoldingRegisters(1000, 20, Modbus::ValueGenerationType::Random);
+    scheduler.addTag(id, {Modbus::TableType::HoldingRegisters, 1000}, 20ms);
+    scheduler.addTag(id, {Modbus::TableType::HoldingRegisters, 1010}, 20ms);
+    scheduler.addTag(id, {Modbus::TableType::HoldingRegisters, 1005}, 50ms);
+    runFor(context, scheduler, {&client}, 80ms);
+
+    std::array<uint16_t, 11> expected{};
+    std::array<uint16_t, 11> published{};
+    device.readHoldingRegisters(1000, expected);
+    mirror.readHoldingRegisters(1000, published);
+    ASSERT_EQ(published, expected);
+    ASSERT_EQ(scheduler.statistics().size(), 2);
+}
+
+TEST_F(PollSchedulerTest, BlockedExecutorSkipsMissedScans) {
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", port());
+    Modbus::DataArea mirror;
+    Modbus::PollScheduler scheduler(context.get_executor());
+    scheduler.addTag(scheduler.addDevice(client, mirror), {Modbus::TableType::HoldingRegisters, 0}, 10ms);
+    // Blocks the executor for ten scans, once the scheduler has started
+    boost::asio::steady_timer block(context, 30ms);
+    block.async_wait([](const boost::system::error_code &) { std::this_thread::sleep_for(100ms); });
+    runFor(context, scheduler, {&client}, 150ms);
+
+    auto statistics = scheduler.statistics().front();
+    ASSERT_GE(statistics.missedScans, 8);
+    // The missed scans were dropped, not fired back to back once the executor was free
+    ASSERT_LE(statistics.scans + statistics.missedScans, 17);
+    ASSERT_GE(statistics.maxJitter, 0us);
+}
+
+TEST_F(PollSchedulerTest, InvalidConfigurationIsRejected) {
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", port());
+    Modbus::DataArea mirror;
+    Modbus::PollScheduler scheduler(context.get_executor());
+    auto id = scheduler.addDevice(client, mirror);
+    ASSERT_THROW(scheduler.addTag(id + 1, {Modbus::TableType::Coils, 0}, 10ms), std::invalid_argument);
+    ASSERT_THROW(scheduler.addTag(id, {Modbus::TableType::Coils, 0}, 0ms), std::invalid_argument);
+    ASSERT_THROW(scheduler.start({.maxRegisters = 0}), std::invalid_argument);
+    scheduler.start();
+    ASSERT_THROW(scheduler.addTag(id, {Modbus::TableType::Coils, 0}, 10ms), std::invalid_argument);
+    ASSERT_THROW(scheduler.start(), std::invalid_argument);
+}
+
+/**
+ * @brief A device answering every Read Holding Registers request for one register after a fixed delay.
+ */
+class SlowDeviceTest : public ::testing::Test {
+protected:
+    boost::asio::io_context serverContext;
+    tcp::acceptor acceptor{serverContext, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)};
+    std::thread deviceThread;
+    std::atomic<int> requests{0};
+    boost::asio::io_context context;
+
+    void startDevice(std::chrono::milliseconds delay) {
+        deviceThread = std::thread([this, delay]() {
+            auto socket = acceptor.accept();
+            std::array<std::byte, 12> request{};
+            boost::system::error_code error;
+            while (boost::asio::read(socket, boost::asio::buffer(request), error) == request.size()) {
+                ++requests;
+                std::this_thread::sleep_for(delay);
+                std::array<std::byte, 11> response{request[0], request[1], std::byte{0x00}, std::byte{0x00},
+                                                   std::byte{0x00}, std::byte{0x05}, request[6], std::byte{0x03},
+                                                   std::byte{0x02}, std::byte{0x00}, std::byte{0x2A}};
+                boost::asio::write(socket, boost::asio::buffer(response), error);
+            }
+        });
+    }
+
+    void TearDown() override {
+        deviceThread.join();
+    }
+};
+
+TEST_F(SlowDeviceTest, ScansDoNotDriftWithPollDuration) {
+    startDevice(15ms);
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", acceptor.local_endpoint().port());
+    Modbus::DataArea mirror;
+    Modbus::PollScheduler scheduler(context.get_executor());
+    scheduler.addTag(scheduler.addDevice(client, mirror), {Modbus::TableType::HoldingRegisters, 0}, 25ms);
+    runFor(context, scheduler, {&client}, 510ms);
+
+    // Scans at 0, 25, ..., 500 ms; sleeping a period after each poll would fit only about 13
+    auto statistics = scheduler.statistics().front();
+    ASSERT_GE(statistics.scans, 19);
+    ASSERT_LE(statistics.scans, 22);
+    ASSERT_EQ(statistics.overruns, 0);
+}
+
+TEST_F(SlowDeviceTest, OverrunningPollsAreSkippedNotQueued) {
+    startDevice(50ms);
+    Modbus::AsyncClient client(context.get_executor(), "127.0.0.1", acceptor.local_endpoint().port());
+    Modbus::DataArea mirror;
+    Modbus::PollScheduler scheduler(context.get_executor());
+    scheduler.addTag(scheduler.addDevice(client, mirror), {Modbus::TableType::HoldingRegisters, 0}, 10ms);
+    runFor(context, scheduler, {&client}, 300ms);
+
+    auto statistics = scheduler.statistics().front();
+    ASSERT_GE(statistics.overruns, 15);
+    // Only the polls the device could answer were sent, about one per 50 ms
+    ASSERT_LE(requests.load(), 8);
+    ASSERT_LE(statistics.failedPolls, 1); // The poll in flight, if any, when the client was disconnected
+    std::array<uint16_t, 1> published{};
+    mirror.readHoldingRegisters(0, published);
+    ASSERT_EQ(published[0], 42);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
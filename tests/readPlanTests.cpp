@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include <ModbusReadPlan.h>
+#include <ModbusUtilities.h>
+
+using Modbus::ReadPoint;
+using Modbus::TableType;
+
+namespace {
+    std::vector<ReadPoint> holdingRegisters(std::initializer_list<uint16_t> addresses) {
+        std::vector<ReadPoint> points;
+        for (auto address: addresses)
+            points.push_back({TableType::HoldingRegisters, address});
+        return points;
+    }
+
+    // Read Holding Registers response whose registers hold their own address
+    std::vector<std::byte> registerResponse(const Modbus::ReadPlan::Request &request) {
+        std::vector<std::byte> response{std::byte{0x03}, static_cast<std::byte>(request.quantity * 2)};
+        for (int i = 0; i < request.quantity; ++i) {
+            auto [msb, lsb] = Modbus::Utilities::uint16ToTwoBytes(static_cast<uint16_t>(request.startAddress + i));
+            response.push_back(msb);
+            response.push_back(lsb);
+        }
+        return response;
+    }
+}
+
+TEST(ReadPlanTest, PointsWithinTheGapShareARequest) {
+    auto points = holdingRegisters({20, 10, 12});
+
+    Modbus::ReadPlan bridged(points, {.registerGap = 7});
+    ASSERT_EQ(bridged.requests().size(), 1);
+    ASSERT_EQ(bridged.requests()[0].startAddress, 10);
+    ASSERT_EQ(bridged.requests()[0].quantity, 11);
+
+    Modbus::ReadPlan split(points, {.registerGap = 6});
+    ASSERT_EQ(split.requests().size(), 2);
+    ASSERT_EQ(split.requests()[0].quantity, 3);
+    ASSERT_EQ(split.requests()[1].startAddress, 20);
+}
+
+TEST(ReadPlanTest, RequestsRespectTheQuantityLimits) {
+    // By default a request reads no more registers than the library's server answers
+    ASSERT_EQ(Modbus::ReadPlan(holdingRegisters({0, 122}), {.registerGap = 200}).requests().size(), 1);
+    ASSERT_EQ(Modbus::ReadPlan(holdingRegisters({0, 123}), {.registerGap = 200}).requests().size(), 2);
+
+    Modbus::ReadPlanOptions protocolLimit{.registerGap = 200,
+                                          .maxRegisters = Modbus::ClientProtocol::MAX_READ_REGISTERS};
+    ASSERT_EQ(Modbus::ReadPlan(holdingRegisters({0, 124}), protocolLimit).requests().size(), 1);
+    ASSERT_EQ(Modbus::ReadPlan(holdingRegisters({0, 125}), protocolLimit).requests().size(), 2);
+    ASSERT_EQ(Modbus::ReadPlan(holdingRegisters({0, 9, 10}), {.maxRegisters = 10}).requests().size(), 2);
+
+    std::vector<ReadPoint> coils{{TableType::Coils, 0}, {TableType::Coils, 1999}, {TableType::Coils, 2000}};
+    Modbus::ReadPlan plan(coils, {.bitGap = 2000});
+    ASSERT_EQ(plan.requests().size(), 2);
+    ASSERT_EQ(plan.requests()[0].quantity, 2000);
+    ASSERT_EQ(plan.requests()[0].functionCode(), Modbus::FunctionCode::ReadCoils);
+}
+
+TEST(ReadPlanTest, TablesAreReadSeparately) {
+    std::vector<ReadPoint> points{{TableType::InputRegisters, 5}, {TableType::HoldingRegisters, 5},
+                                  {TableType::DiscreteInputs, 5}, {TableType::HoldingRegisters, 6}};
+    Modbus::ReadPlan plan(points);
+    ASSERT_EQ(plan.requests().size(), 3);
+    for (const auto &request: plan.requests())
+        ASSERT_EQ(request.quantity, request.table == TableType::HoldingRegisters ? 2 : 1);
+}
+
+TEST(ReadPlanTest, ScatterReturnsValuesInPointOrder) {
+    // Scattered and repeated points, split across two requests
+    auto points = holdingRegisters({300, 7, 12, 7, 301});
+    Modbus::ReadPlan plan(points);
+    ASSERT_EQ(plan.requests().size(), 2);
+    ASSERT_EQ(plan.pointCount(), 5);
+
+    std::vector<uint16_t> values(plan.pointCount());
+    for (std::size_t i = 0; i < plan.requests().size(); ++i)
+        plan.scatter(i, registerResponse(plan.requests()[i]), values);
+    ASSERT_EQ(values, (std::vector<uint16_t>{300, 7, 12, 7, 301}));
+}
+
+TEST(ReadPlanTest, ScatterUnpacksBits) {
+    std::vector<ReadPoint> points{{TableType::Coils, 9}, {TableType::Coils, 0}, {TableType::Coils, 3}};
+    Modbus::ReadPlan plan(points);
+    ASSERT_EQ(plan.requests().size(), 1);
+
+    // Coils 0 to 9, with coils 3 and 9 on
+    std::vector<std::byte> response{std::byte{0x01}, std::byte{0x02}, std::byte{0x08}, std::byte{0x02}};
+    std::vector<uint16_t> values(plan.pointCount());
+    plan.scatter(0, response, values);
+    ASSERT_EQ(values, (std::vector<uint16_t>{1, 0, 1}));
+}
+
+TEST(ReadPlanTest, InvalidLimitsAreRejected) {
+    auto points = holdingRegisters({0});
+    ASSERT_THROW(Modbus::ReadPlan(points, {.maxRegisters = 0}), std::invalid_argument);
+    ASSERT_THROW(Modbus::ReadPlan(points, {.maxRegisters = 126}), std::invalid_argument);
+    ASSERT_THROW(Modbus::ReadPlan(points, {.maxBits = 2001}), std::invalid_argument);
+    ASSERT_TRUE(Modbus::ReadPlan(std::vector<ReadPoint>{}).requests().empty());
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <ModbusDataArea.h>
+#include <ModbusServer.h>
+
+using boost::asio::ip::tcp;
+
+class ServerTest : public ::testing::Test {
+protected:
+    Modbus::DataArea dataArea;
+    boost::asio::io_context clientContext;
+
+    void SetUp() override {
+        dataArea.insertHoldingRegister(Modbus::HoldingRegister(0, 0x1234));
+    }
+
+    static Modbus::Server::ServerOptions loopbackOptions() {
+        Modbus::Server::ServerOptions options;
+        options.endpoints = {tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)};
+        options.workerThreads = 2;
+        return options;
+    }
+
+    // Builds a Read Holding Registers request for address 0 of the given unit
+    static std::array<std::byte, 12> readFirstHoldingRegisterRequest(uint8_t unit, uint8_t transaction = 1) {
+        return {std::byte{0x00}, std::byte{transaction}, // Transaction Identifier
+                std::byte{0x00}, std::byte{0x00}, // Protocol Identifier
+                std::byte{0x00}, std::byte{0x06}, // Length = 6
+                std::byte{unit}, // Unit Identifier
+                std::byte{0x03}, // Function code: Read Holding Registers (3)
+                std::byte{0x00}, std::byte{0x00}, // Starting address = 0
+                std::byte{0x00}, std::byte{0x01}}; // Quantity = 1
+    }
+
+    // Sends a Read Holding Registers request for address 0 and returns the register value of the response
+    uint16_t readFirstHoldingRegister(const tcp::endpoint &endpoint, uint8_t unit = 1) {
+        tcp::socket socket(clientContext);
+        socket.connect(endpoint);
+        boost::asio::write(socket, boost::asio::buffer(readFirstHoldingRegisterRequest(unit)));
+        std::array<std::byte, 11> response{};
+        boost::asio::read(socket, boost::asio::buffer(response));
+        return static_cast<uint16_t>((std::to_integer<int>(response[9]) << 8) | std::to_integer<int>(response[10]));
+    }
+};
+
+TEST_F(ServerTest, EphemeralPortIsReportedByLocalEndpoints) {
+    Modbus::Server::MBServer server(dataArea, loopbackOptions());
+
+    auto endpoints = server.localEndpoints();
+    ASSERT_EQ(endpoints.size(), 1);
+    ASSERT_NE(endpoints[0].port(), 0);
+    ASSERT_EQ(server.workerThreads(), 2);
+}
+
+TEST_F(ServerTest, ServesRequestsOnEveryEndpoint) {
+    auto options = loopbackOptions();
+    options.endpoints.emplace_back(boost::asio::ip::address_v4::loopback(), 0);
+    Modbus::Server::MBServer server(dataArea, options);
+    std::thread serverThread([&server]() { server.start(); });
+
+    for (const auto &endpoint: server.localEndpoints())
+        ASSERT_EQ(readFirstHoldingRegister(endpoint), 0x1234);
+
+    server.stop();
+    serverThread.join();
+}
+
+TEST_F(ServerTest, ReusePortWorkersShareOneEphemeralPort) {
+    auto options = loopbackOptions();
+    options.acceptMode = Modbus::Server::AcceptMode::ReusePortPerWorker;
+    options.workerThreads = 4;
+    Modbus::Server::MBServer server(dataArea, options);
+    std::thread serverThread([&server]() { server.start(); });
+
+    auto endpoint = server.localEndpoints().front();
+    for (int i = 0; i < 16; ++i)
+        ASSERT_EQ(readFirstHoldingRegister(endpoint), 0x1234);
+
+    server.stop();
+    serverThread.join();
+}
+
+TEST_F(ServerTest, UnitIdentifierSelectsDataArea) {
+    Modbus::DataArea firstUnit;
+    Modbus::DataArea secondUnit;
+    firstUnit.insertHoldingRegister(Modbus::HoldingRegister(0, 0x1111));
+    secondUnit.insertHoldingRegister(Modbus::HoldingRegister(0, 0x2222));
+    Modbus::Server::UnitMap units(dataArea);
+    units.add(1, firstUnit);
+    units.add(247, secondUnit);
+    Modbus::Server::MBServer server(units, loopbackOptions());
+    std::thread serverThread([&server]() { server.start(); });
+
+    auto endpoint = server.localEndpoints().front();
+    ASSERT_EQ(readFirstHoldingRegister(endpoint, 1), 0x1111);
+    ASSERT_EQ(readFirstHoldingRegister(endpoint, 247), 0x2222);
+    ASSERT_EQ(readFirstHoldingRegister(endpoint, 12), 0x1234); // Served by the default data area
+
+    server.stop();
+    serverThread.join();
+}
+
+TEST_F(ServerTest, UnknownUnitIsAnsweredWithGatewayException) {
+    Modbus::Server::UnitMap units;
+    units.add(1, dataArea);
+    Modbus::Server::MBServer server(units, loopbackOptions());
+    std::thread serverThread([&server]() { server.start(); });
+
+    tcp::socket socket(clientContext);
+    socket.connect(server.localEndpoints().front());
+    boost::asio::write(socket, boost::asio::buffer(readFirstHoldingRegisterRequest(2)));
+    std::array<std::byte, 9> response{};
+    boost::asio::read(socket, boost::asio::buffer(response));
+
+    ASSERT_EQ(response[6], std::byte{0x02}); // Unit Identifier
+    ASSERT_EQ(response[7], std::byte{0x83}); // Exception to Read Holding Registers
+    ASSERT_EQ(response[8], static_cast<std::byte>(Modbus::ExceptionCode::GatewayPathUnavailable));
+
+    server.stop();
+    serverThread.join();
+}
+
+TEST_F(ServerTest, BroadcastWriteReachesEveryUnitWithoutResponse) {
+    Modbus::DataArea otherUnit;
+    otherUnit.insertHoldingRegister(Modbus::HoldingRegister(0, 0));
+    Modbus::Server::UnitMap units;
+    units.add(1, dataArea);
+    units.add(2, otherUnit);
+    units.add(3, otherUnit);
+    units.setBroadcast(true);
+    Modbus::Server::MBServer server(units, loopbackOptions());
+    std::thread serverThread([&server]() { server.start(); });
+
+    tcp::socket socket(clientContext);
+    socket.connect(server.localEndpoints().front());
+    std::array<std::byte, 12> broadcast{std::byte{0x00}, std::byte{0x07}, // Transaction Identifier
+                                        std::byte{0x00}, std::byte{0x00}, // Protocol Identifier
+                                        std::byte{0x00}, std::byte{0x06}, // Length = 6
+                                        std::byte{0x00}, // Unit Identifier: broadcast
+                                        std::byte{0x06}, // Function code: Write Single Register (6)
+                                        std::byte{0x00}, std::byte{0x00}, // Register address = 0
+                                        std::byte{0xAB}, std::byte{0xCD}}; // Value
+    boost::asio::write(socket, boost::asio::buffer(broadcast));
+    // The first response on the connection must be the answer to the read, not to the broadcast
+    boost::asio::write(socket, boost::asio::buffer(readFirstHoldingRegisterRequest(2, 8)));
+    std::array<std::byte, 11> response{};
+    boost::asio::read(socket, boost::asio::buffer(response));
+
+    ASSERT_EQ(response[1], std::byte{0x08}); // Transaction Identifier of the read
+    ASSERT_EQ(response[9], std::byte{0xAB});
+    ASSERT_EQ(response[10], std::byte{0xCD});
+    ASSERT_EQ(dataArea.getHoldingRegisters(0, 1)[0].read(), 0xABCD);
+
+    server.stop();
+    serverThread.join();
+}
+
+TEST_F(ServerTest, UnitMapRejectsConflictingRoutes) {
+    Modbus::Server::UnitMap units;
+    units.add(5, dataArea);
+    ASSERT_THROW(units.add(5, dataArea), std::invalid_argument);
+    units.setBroadcast(true);
+    ASSERT_THROW(units.add(Modbus::Server::UnitMap::BROADCAST_UNIT, dataArea), std::invalid_argument);
+    ASSERT_EQ(units.find(6), nullptr);
+    ASSERT_EQ(units.dataAreas().size(), 1);
+}
+
+TEST_F(ServerTest, ReplacedDefaultNoLongerReceivesBroadcasts) {
+    Modbus::DataArea firstDefault;
+    Modbus::DataArea secondDefault;
+    Modbus::DataArea thirdDefault;
+    Modbus::Server::UnitMap units(firstDefault);
+    units.add(1, dataArea);
+    units.setDefault(secondDefault);
+    ASSERT_EQ(units.dataAreas(), (std::vector<Modbus::DataArea *>{&dataArea, &secondDefault}));
+
+    // A replaced default that also serves a unit keeps receiving broadcasts
+    units.add(2, secondDefault);
+    units.setDefault(thirdDefault);
+    ASSERT_EQ(units.dataAreas(), (std::vector<Modbus::DataArea *>{&dataArea, &secondDefault, &thirdDefault}));
+    units.setDefault(thirdDefault);
+    ASSERT_EQ(units.dataAreas().size(), 3);
+}
+
+TEST_F(ServerTest, NoEndpointThrowsException) {
+    auto options = loopbackOptions();
+    options.endpoints.clear();
+    ASSERT_THROW(Modbus::Server::MBServer(dataArea, options), std::invalid_argument);
+}
+
+TEST_F(ServerTest, NonPositiveBacklogThrowsException) {
+    auto options = loopbackOptions();
+    options.backlog = 0;
+    ASSERT_THROW(Modbus::Server::MBServer(dataArea, options), std::invalid_argument);
+}
+
+TEST_F(ServerTest, NegativeBufferSizeThrowsException) {
+    auto options = loopbackOptions();
+    options.receiveBufferSize = -1;
+    ASSERT_THROW(Modbus::Server::MBServer(dataArea, options), std::invalid_argument);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}